@@ -22,6 +22,8 @@
 
 Q_LOGGING_CATEGORY(eepromImport, "eeprom.import")
 
+Q_LOGGING_CATEGORY(eepromTiming, "eeprom.timing")
+
 Q_LOGGING_CATEGORY(simulatorInterfaceLoader, "simulator.interface.loader")
 
 void CustomDebug::setFilterRules()
@@ -34,6 +36,7 @@ void CustomDebug::setFilterRules()
   rules.append("false\n");
 #endif
 
+  rules.append("eeprom.timing=false\n");
   rules.append("simulator.interface.*=true\n");
 
   QLoggingCategory::setFilterRules(rules);
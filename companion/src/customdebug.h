@@ -26,6 +26,9 @@
 // Controls the generation of debug output for EEPROM import
 Q_DECLARE_LOGGING_CATEGORY(eepromImport)  // "eeprom.import"
 
+// Controls the generation of timing output for EEPROM import / export (QT_LOGGING_RULES="eeprom.timing=true")
+Q_DECLARE_LOGGING_CATEGORY(eepromTiming)  // "eeprom.timing"
+
 // Controls the generation of debug output of SimulatorLoader class
 Q_DECLARE_LOGGING_CATEGORY(simulatorInterfaceLoader)  // "simulator.interface.loader"
 
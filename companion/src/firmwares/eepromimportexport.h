@@ -24,7 +24,109 @@
 #include "customdebug.h"
 
 #include <QtCore>
-#include <QBitArray>
+
+// Writes bit fields in a QByteArray, least significant bits first, through a 64 bits accumulator
+class BitWriter {
+  public:
+    explicit BitWriter(QByteArray & output):
+      output(output),
+      accumulator(0),
+      count(0),
+      total(0)
+    {
+    }
+
+    // Writes the 'size' lower bits of value, or value followed by zeroes when size is more than 64 bits
+    void write(quint64 value, unsigned int size)
+    {
+      total += size;
+      while (size) {
+        unsigned int n = qMin(size, 64 - count);
+        accumulator |= (n == 64 ? value : value & ((Q_UINT64_C(1) << n) - 1)) << count;
+        value = (n == 64 ? 0 : value >> n);
+        count += n;
+        size -= n;
+        if (count == 64) {
+          uchar bytes[8];
+          qToLittleEndian(accumulator, bytes);
+          output.append((const char *)bytes, 8);
+          accumulator = 0;
+          count = 0;
+        }
+      }
+    }
+
+    // Writes the remaining bits, the last byte is padded with zeroes
+    void flush()
+    {
+      uchar bytes[8];
+      qToLittleEndian(accumulator, bytes);
+      output.append((const char *)bytes, (count + 7) / 8);
+      accumulator = 0;
+      count = 0;
+    }
+
+    unsigned int position() const
+    {
+      return total;
+    }
+
+  protected:
+    QByteArray & output;
+    quint64 accumulator;
+    unsigned int count;
+    unsigned int total;
+};
+
+// Reads bit fields written by BitWriter, up to 64 bits at a time
+class BitReader {
+  public:
+    explicit BitReader(const QByteArray & input):
+      data((const uchar *)input.constData()),
+      length(input.size()),
+      offset(0)
+    {
+    }
+
+    // Reads 'size' bits, only the first 64 bits are returned when size is more than 64 bits
+    quint64 read(unsigned int size)
+    {
+      quint64 result = 0;
+      unsigned int done = 0;
+      while (done < size && done < 64) {
+        unsigned int shift = offset & 7;
+        unsigned int n = qMin(qMin(size - done, 64 - shift), 64 - done);
+        quint64 word = load(offset >> 3) >> shift;
+        result |= (n == 64 ? word : word & ((Q_UINT64_C(1) << n) - 1)) << done;
+        done += n;
+        offset += n;
+      }
+      offset += size - done;
+      return result;
+    }
+
+    unsigned int position() const
+    {
+      return offset;
+    }
+
+  protected:
+    quint64 load(unsigned int index) const
+    {
+      if (index + 8 <= length) {
+        return qFromLittleEndian<quint64>(&data[index]);
+      }
+      uchar bytes[8] = { 0 };
+      for (unsigned int i=0; index+i<length && i<8; i++) {
+        bytes[i] = data[index+i];
+      }
+      return qFromLittleEndian<quint64>(bytes);
+    }
+
+    const uchar * data;
+    unsigned int length;
+    unsigned int offset;
+};
 
 class DataField {
   Q_DECLARE_TR_FUNCTIONS(DataField)
@@ -46,60 +148,42 @@ class DataField {
     }
 
     virtual unsigned int size() = 0;
-    virtual void ExportBits(QBitArray & output) = 0;
-    virtual void ImportBits(const QBitArray & input) = 0;
-
-    QBitArray bytesToBits(QByteArray bytes)
-    {
-      QBitArray bits(bytes.count()*8);
-      // Convert from QByteArray to QBitArray
-      for (int i=0; i<bytes.count(); ++i)
-        for (int b=0; b<8; ++b)
-          bits.setBit(i*8+b, bytes.at(i)&(1<<b));
-      return bits;
-    }
-
-    QByteArray bitsToBytes(QBitArray bits, int offset=0)
-    {
-      QByteArray bytes;
-      bytes.resize((offset+bits.count()+7)/8);
-      bytes.fill(0);
-      // Convert from QBitArray to QByteArray
-      for (int b=0; b<bits.count(); ++b)
-        bytes[(b+offset)/8] = ( bytes.at((b+offset)/8) | ((bits[b]?1:0)<<((b+offset)%8)));
-      return bytes;
-    }
+    virtual void ExportBits(BitWriter & output) = 0;
+    virtual void ImportBits(BitReader & input) = 0;
 
     int Export(QByteArray & output)
     {
-      QBitArray result;
-      ExportBits(result);
-      output = bitsToBytes(result);
+      output.clear();
+      BitWriter writer(output);
+      ExportBits(writer);
+      writer.flush();
       return 0;
     }
 
     int Import(const QByteArray & input)
     {
-      QBitArray bits = bytesToBits(input);
-      if ((unsigned int)bits.size() < size()) {
+      if ((unsigned int)input.size()*8 < size()) {
         qDebug() << QString("Error importing %1: size to small %2/%3").arg(getName()).arg(input.size()).arg(size());
         return -1;
       }
-      ImportBits(bits);
+      BitReader reader(input);
+      ImportBits(reader);
       return 0;
     }
 
     virtual int Dump(int level=0, int offset=0)
     {
-      QBitArray bits;
-      ExportBits(bits);
-      QByteArray bytes = bitsToBytes(bits);
-      int result = (offset+bits.count()) % 8;
+      QByteArray bytes;
+      BitWriter writer(bytes);
+      ExportBits(writer);
+      writer.flush();
+      int count = writer.position();
+      int result = (offset+count) % 8;
       for (int i=0; i<level; i++) printf("  ");
-      if (bits.count() % 8 == 0)
+      if (count % 8 == 0)
         printf("%s (%dbytes) ", getName().toLatin1().constData(), bytes.count());
       else
-        printf("%s (%dbits) ", getName().toLatin1().constData(), bits.count());
+        printf("%s (%dbits) ", getName().toLatin1().constData(), count);
       for (int i=0; i<bytes.count(); i++) {
         unsigned char c = bytes[i];
         if ((i==0 && offset) || (i==bytes.count()-1 && result!=0))
@@ -164,27 +248,18 @@ class BaseUnsignedField: public DataField {
     {
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(BitWriter & output)
     {
       container value = field;
       if (value > max) value = max;
       if (value < min) value = min;
 
-      output.resize(N);
-      for (int i=0; i<N; i++) {
-        if (value & ((container)1<<i)) {
-          output.setBit(i);
-        }
-      }
+      output.write(value, N);
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(BitReader & input)
     {
-      field = 0;
-      for (int i=0; i<N; i++) {
-        if (input[i])
-          field |= ((container)1<<i);
-      }
+      field = (container)input.read(N);
       qCDebug(eepromImport) << QString("\timported %1<%2>: 0x%3(%4)").arg(name).arg(N).arg(field, 0, 16).arg(field);
     }
 
@@ -231,17 +306,14 @@ class BoolField: public DataField {
     {
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(BitWriter & output)
     {
-      output.resize(N);
-      if (field) {
-        output.setBit(0);
-      }
+      output.write(field ? 1 : 0, N);
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(BitReader & input)
     {
-      field = input[0] ? true : false;
+      field = (input.read(N) & 1) ? true : false;
       qCDebug(eepromImport) << QString("\timported %1<%2>: 0x%3(%4)").arg(name).arg(N).arg(field, 0, 16).arg(field);
     }
 
@@ -284,31 +356,21 @@ class SignedField: public DataField {
     {
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(BitWriter & output)
     {
       int value = field;
       if (value > max) value = max;
       if (value < min) value = min;
 
-      output.resize(N);
-      for (int i=0; i<N; i++) {
-        if (((unsigned int)value) & (1<<i))
-          output.setBit(i);
-      }
+      output.write((unsigned int)value, N);
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(BitReader & input)
     {
-      unsigned int value = 0;
-      for (int i=0; i<N; i++) {
-        if (input[i])
-          value |= (1<<i);
-      }
+      unsigned int value = (unsigned int)input.read(N);
 
-      if (input[N-1]) {
-        for (unsigned int i=N; i<8*sizeof(int); i++) {
-          value |= (1<<i);
-        }
+      if ((unsigned int)N < 8*sizeof(int) && (value & (1u<<(N-1)))) {
+        value |= ~0u << (N % (8*sizeof(int)));
       }
 
       field = (int)value;
@@ -348,30 +410,18 @@ class CharField: public DataField {
     {
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(BitWriter & output)
     {
-      output.resize(N*8);
-      int b = 0;
       int len = truncate ? strlen(field) : N;
       for (int i=0; i<N; i++) {
-        int idx = (i>=len ? 0 : field[i]);
-        for (int j=0; j<8; j++, b++) {
-          if (idx & (1<<j))
-            output.setBit(b);
-        }
+        output.write(i>=len ? 0 : (uint8_t)field[i], 8);
       }
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(BitReader & input)
     {
-      unsigned int b = 0;
       for (int i=0; i<N; i++) {
-        int8_t idx = 0;
-        for (int j=0; j<8; j++) {
-          if (input[b++])
-            idx |= (1<<j);
-        }
-        field[i] = idx;
+        field[i] = (int8_t)input.read(8);
       }
       qCDebug(eepromImport) << QString("\timported %1<%2>: '%3'").arg(name).arg(N).arg(field);
     }
@@ -423,30 +473,18 @@ class ZCharField: public DataField {
     {
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(BitWriter & output)
     {
-      output.resize(N*8);
-      int b = 0;
       int len = strlen(field);
       for (int i=0; i<N; i++) {
-        int idx = i>=len ? 0 : char2idx(field[i]);
-        for (int j=0; j<8; j++, b++) {
-          if (idx & (1<<j))
-            output.setBit(b);
-        }
+        output.write(i>=len ? 0 : (uint8_t)char2idx(field[i]), 8);
       }
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(BitReader & input)
     {
-      unsigned int b = 0;
       for (int i=0; i<N; i++) {
-        int8_t idx = 0;
-        for (int j=0; j<8; j++) {
-          if (input[b++])
-            idx |= (1<<j);
-        }
-        field[i] = idx2char(idx);
+        field[i] = idx2char((int8_t)input.read(8));
       }
 
       field[N] = '\0';
@@ -486,29 +524,18 @@ class StructField: public DataField {
       fields.append(field);
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(BitWriter & output)
     {
-      int offset = 0;
-      output.resize(size());
       foreach(DataField *field, fields) {
-        QBitArray bits;
-        field->ExportBits(bits);
-        for (int i=0; i<bits.size(); i++)
-          output[offset++] = bits[i];
+        field->ExportBits(output);
       }
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(BitReader & input)
     {
       qCDebug(eepromImport) << QString("\timporting %1[%2]:").arg(name).arg(fields.size());
-      int offset = 0;
       foreach(DataField *field, fields) {
-        unsigned int size = field->size();
-        QBitArray bits(size);
-        for (unsigned int i=0; i<size; i++) {
-          bits[i] = input[offset++];
-        }
-        field->ImportBits(bits);
+        field->ImportBits(input);
       }
     }
 
@@ -547,13 +574,13 @@ class TransformedField: public DataField {
     {
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(BitWriter & output)
     {
       beforeExport();
       field.ExportBits(output);
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(BitReader & input)
     {
       qCDebug(eepromImport) << QString("\timporting TransformedField %1:").arg(field.getName());
       field.ImportBits(input);
@@ -590,67 +617,50 @@ class ConversionTable {
   public:
     bool exportValue(const int before, int &after)
     {
-      after = 0;
-
-      for (std::list<ConversionTuple>::iterator it=exportTable.begin(); it!=exportTable.end(); it++) {
-        ConversionTuple & tuple = *it;
-        if (before == tuple.a) {
-          after = tuple.b;
-          return true;
-        }
+      QHash<int, int>::const_iterator it = exportTable.constFind(before);
+      if (it == exportTable.constEnd()) {
+        after = 0;
+        return false;
       }
 
-      return false;
+      after = it.value();
+      return true;
     }
 
     bool importValue(const int before, int &after)
     {
-      after = 0;
-
-      for (std::list<ConversionTuple>::iterator it=importTable.begin(); it!=importTable.end(); it++) {
-        ConversionTuple & tuple = *it;
-        if (before == tuple.b) {
-          after = tuple.a;
-          return true;
-        }
+      QHash<int, int>::const_iterator it = importTable.constFind(before);
+      if (it == importTable.constEnd()) {
+        after = 0;
+        return false;
       }
 
-      return false;
+      after = it.value();
+      return true;
     }
 
   protected:
-
-    class ConversionTuple {
-      public:
-        ConversionTuple(const int a, const int b):
-          a(a),
-          b(b)
-        {
-        }
-
-        int a;
-        int b;
-    };
-
+    // the first conversion added for a given value wins
     void addConversion(const int a, const int b)
     {
-      ConversionTuple conversion(a, b);
-      importTable.push_back(conversion);
-      exportTable.push_back(conversion);
+      addImportConversion(a, b);
+      addExportConversion(a, b);
     }
 
     void addImportConversion(const int a, const int b)
     {
-      importTable.push_back(ConversionTuple(a, b));
+      if (!importTable.contains(b))
+        importTable.insert(b, a);
     }
 
     void addExportConversion(const int a, const int b)
     {
-      exportTable.push_back(ConversionTuple(a, b));
+      if (!exportTable.contains(a))
+        exportTable.insert(a, b);
     }
 
-    std::list<ConversionTuple> importTable;
-    std::list<ConversionTuple> exportTable;
+    QHash<int, int> importTable;
+    QHash<int, int> exportTable;
 };
 
 template<class T>
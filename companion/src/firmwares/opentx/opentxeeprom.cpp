@@ -68,6 +68,63 @@ inline int switchIndex(int i, Board::Type board, unsigned int version)
     return i;
 }
 
+// Conversion tables only depend on the board, version, variant and flags, they are built once and shared by all fields
+// The models of a categorized storage are decoded / encoded in parallel, hence the mutex
+template <class T>
+class ConversionTablesCache {
+  public:
+    T * find(Board::Type board, unsigned int version, unsigned int variant=0, unsigned long flags=0)
+    {
+      QMutexLocker locker(&mutex);
+      return lookup(board, version, variant, flags);
+    }
+
+    T * insert(Board::Type board, unsigned int version, unsigned int variant, unsigned long flags, T * table)
+    {
+      QMutexLocker locker(&mutex);
+      T * existing = lookup(board, version, variant, flags);
+      if (existing) {
+        // another thread built the same table in the meantime
+        delete table;
+        return existing;
+      }
+      Element element = { board, version, variant, flags, table };
+      elements.push_back(element);
+      return table;
+    }
+
+    void clear()
+    {
+      QMutexLocker locker(&mutex);
+      for (typename std::list<Element>::iterator it=elements.begin(); it!=elements.end(); it++) {
+        delete it->table;
+      }
+      elements.clear();
+    }
+
+  protected:
+    struct Element {
+      Board::Type board;
+      unsigned int version;
+      unsigned int variant;
+      unsigned long flags;
+      T * table;
+    };
+
+    T * lookup(Board::Type board, unsigned int version, unsigned int variant, unsigned long flags)
+    {
+      for (typename std::list<Element>::iterator it=elements.begin(); it!=elements.end(); it++) {
+        Element & element = *it;
+        if (element.board == board && element.version == version && element.variant == variant && element.flags == flags)
+          return element.table;
+      }
+      return NULL;
+    }
+
+    std::list<Element> elements;
+    QMutex mutex;
+};
+
 class SwitchesConversionTable: public ConversionTable {
 
   public:
@@ -189,49 +246,25 @@ class SwitchesConversionTable: public ConversionTable {
       ConversionTable::addExportConversion(sw.toValue(), b);
     }
 
-    class Cache {
-      public:
-        Cache(Board::Type board, unsigned int version, unsigned long flags, SwitchesConversionTable * table):
-          board(board),
-          version(version),
-          flags(flags),
-          table(table)
-        {
-        }
-        Board::Type board;
-        unsigned int version;
-        unsigned long flags;
-        SwitchesConversionTable * table;
-    };
-
-    static std::list<Cache> internalCache;
+    static ConversionTablesCache<SwitchesConversionTable> internalCache;
 
   public:
 
     static SwitchesConversionTable * getInstance(Board::Type board, unsigned int version, unsigned long flags=0)
     {
-      for (std::list<Cache>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
-        Cache & element = *it;
-        if (element.board == board && element.version == version && element.flags == flags)
-          return element.table;
-      }
-
-      Cache element(board, version, flags, new SwitchesConversionTable(board, version, flags));
-      internalCache.push_back(element);
-      return element.table;
+      SwitchesConversionTable * table = internalCache.find(board, version, 0, flags);
+      if (!table)
+        table = internalCache.insert(board, version, 0, flags, new SwitchesConversionTable(board, version, flags));
+      return table;
     }
+
     static void Cleanup()
     {
-      for (std::list<Cache>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
-        Cache & element = *it;
-        if (element.table)
-          delete element.table;
-      }
       internalCache.clear();
     }
 };
 
-std::list<SwitchesConversionTable::Cache> SwitchesConversionTable::internalCache;
+ConversionTablesCache<SwitchesConversionTable> SwitchesConversionTable::internalCache;
 
 #define FLAG_NONONE       0x01
 #define FLAG_NOSWITCHES   0x02
@@ -379,56 +412,25 @@ class SourcesConversionTable: public ConversionTable {
       ConversionTable::addConversion(source.toValue(), b);
     }
 
-    class Cache {
-      public:
-        Cache(Board::Type board, unsigned int version, unsigned int variant, unsigned long flags, SourcesConversionTable * table):
-          board(board),
-          version(version),
-          variant(variant),
-          flags(flags),
-          table(table)
-        {
-        }
-        Board::Type board;
-        unsigned int version;
-        unsigned int variant;
-        unsigned long flags;
-        SourcesConversionTable * table;
-    };
-    static std::list<Cache> internalCache;
+    static ConversionTablesCache<SourcesConversionTable> internalCache;
 
   public:
 
     static SourcesConversionTable * getInstance(Board::Type board, unsigned int version, unsigned int variant, unsigned long flags=0)
     {
-      for (std::list<Cache>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
-        Cache & element = *it;
-        if (element.board == board && element.version == version && element.variant == variant && element.flags == flags)
-          return element.table;
-      }
-
-      Cache element(board, version, variant, flags, new SourcesConversionTable(board, version, variant, flags));
-      internalCache.push_back(element);
-      return element.table;
+      SourcesConversionTable * table = internalCache.find(board, version, variant, flags);
+      if (!table)
+        table = internalCache.insert(board, version, variant, flags, new SourcesConversionTable(board, version, variant, flags));
+      return table;
     }
+
     static void Cleanup()
     {
-      for (std::list<Cache>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
-        Cache & element = *it;
-        if (element.table)
-          delete element.table;
-      }
       internalCache.clear();
     }
 };
 
-std::list<SourcesConversionTable::Cache> SourcesConversionTable::internalCache;
-
-void OpenTxEepromCleanup(void)
-{
-  SourcesConversionTable::Cleanup();
-  SwitchesConversionTable::Cleanup();
-}
+ConversionTablesCache<SourcesConversionTable> SourcesConversionTable::internalCache;
 
 template <int N>
 class SwitchField: public ConversionField< SignedField<N> > {
@@ -553,14 +555,31 @@ class TelemetrySourcesConversionTable: public ConversionTable {
       addConversion(1+TELEMETRY_SOURCE_ACC, val++);
       addConversion(1+TELEMETRY_SOURCE_GPS_TIME, val++);
     }
+
+    static TelemetrySourcesConversionTable * getInstance(Board::Type board, unsigned int version)
+    {
+      TelemetrySourcesConversionTable * table = internalCache.find(board, version);
+      if (!table)
+        table = internalCache.insert(board, version, 0, 0, new TelemetrySourcesConversionTable(board, version));
+      return table;
+    }
+
+    static void Cleanup()
+    {
+      internalCache.clear();
+    }
+
+  protected:
+    static ConversionTablesCache<TelemetrySourcesConversionTable> internalCache;
 };
 
+ConversionTablesCache<TelemetrySourcesConversionTable> TelemetrySourcesConversionTable::internalCache;
+
 template <int N>
 class TelemetrySourceField: public ConversionField< UnsignedField<N> > {
   public:
     TelemetrySourceField(DataField * parent, RawSource & source, Board::Type board, unsigned int version):
-      ConversionField< UnsignedField<N> >(parent, _source, &conversionTable, "Telemetry source"),
-      conversionTable(board, version),
+      ConversionField< UnsignedField<N> >(parent, _source, TelemetrySourcesConversionTable::getInstance(board, version), "Telemetry source"),
       source(source),
       board(board),
       version(version),
@@ -586,7 +605,6 @@ class TelemetrySourceField: public ConversionField< UnsignedField<N> > {
     }
 
   protected:
-    TelemetrySourcesConversionTable conversionTable;
     RawSource & source;
     Board::Type board;
     unsigned int version;
@@ -1687,8 +1705,26 @@ class LogicalSwitchesFunctionsTable: public ConversionTable {
       if (version >= 216)
         addConversion(LS_FN_STICKY, val++);
     }
+
+    static LogicalSwitchesFunctionsTable * getInstance(Board::Type board, unsigned int version)
+    {
+      LogicalSwitchesFunctionsTable * table = internalCache.find(board, version);
+      if (!table)
+        table = internalCache.insert(board, version, 0, 0, new LogicalSwitchesFunctionsTable(board, version));
+      return table;
+    }
+
+    static void Cleanup()
+    {
+      internalCache.clear();
+    }
+
+  protected:
+    static ConversionTablesCache<LogicalSwitchesFunctionsTable> internalCache;
 };
 
+ConversionTablesCache<LogicalSwitchesFunctionsTable> LogicalSwitchesFunctionsTable::internalCache;
+
 class AndSwitchesConversionTable: public ConversionTable {
 
   public:
@@ -1740,27 +1776,21 @@ class AndSwitchesConversionTable: public ConversionTable {
     static ConversionTable * getInstance(Board::Type board, unsigned int version)
     {
       if (IS_ARM(board) && version >= 216)
-        return new SwitchesConversionTable(board, version);
-      else
-        return new AndSwitchesConversionTable(board, version);
-
-#if 0
-      static std::list<Cache> internalCache;
-
-      for (std::list<Cache>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
-        Cache element = *it;
-        if (element.board == board && element.version == version && element.flags == flags)
-          return element.table;
-      }
+        return SwitchesConversionTable::getInstance(board, version);
 
-      Cache element(board, version, flags, new SwitchesConversionTable(board, version, flags));
-      internalCache.push_back(element);
-      return element.table;
-#endif
+      AndSwitchesConversionTable * table = internalCache.find(board, version);
+      if (!table)
+        table = internalCache.insert(board, version, 0, 0, new AndSwitchesConversionTable(board, version));
+      return table;
     }
 
+    static void Cleanup()
+    {
+      internalCache.clear();
+    }
 
   protected:
+    static ConversionTablesCache<AndSwitchesConversionTable> internalCache;
 
     void addConversion(const RawSwitch & sw, const int b)
     {
@@ -1768,6 +1798,8 @@ class AndSwitchesConversionTable: public ConversionTable {
     }
 };
 
+ConversionTablesCache<AndSwitchesConversionTable> AndSwitchesConversionTable::internalCache;
+
 class LogicalSwitchField: public TransformedField {
   public:
     LogicalSwitchField(DataField * parent, LogicalSwitchData & csw, Board::Type board, unsigned int version, unsigned int variant, ModelData * model=NULL):
@@ -1778,7 +1810,7 @@ class LogicalSwitchField: public TransformedField {
       version(version),
       variant(variant),
       model(model),
-      functionsConversionTable(board, version),
+      functionsConversionTable(LogicalSwitchesFunctionsTable::getInstance(board, version)),
       sourcesConversionTable(SourcesConversionTable::getInstance(board, version, variant, (version >= 214 || (!IS_ARM(board) && version >= 213)) ? 0 : FLAG_NOSWITCHES)),
       switchesConversionTable(SwitchesConversionTable::getInstance(board, version)),
       andswitchesConversionTable(AndSwitchesConversionTable::getInstance(board, version)),
@@ -1787,7 +1819,7 @@ class LogicalSwitchField: public TransformedField {
       v3(0)
     {
       if (IS_ARM(board) && version >= 218) {
-        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, &functionsConversionTable, "Function"));
+        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, functionsConversionTable, "Function"));
         internalField.Append(new SignedField<10>(this, v1));
         internalField.Append(new SignedField<10>(this, v3));
         internalField.Append(new ConversionField< SignedField<9> >(this, (int &)csw.andsw, andswitchesConversionTable, "AND switch"));
@@ -1796,7 +1828,7 @@ class LogicalSwitchField: public TransformedField {
         internalField.Append(new SignedField<16>(this, v2));
       }
       else if (IS_ARM(board) && version >= 217) {
-        internalField.Append(new ConversionField< UnsignedField<6> >(this, csw.func, &functionsConversionTable, "Function"));
+        internalField.Append(new ConversionField< UnsignedField<6> >(this, csw.func, functionsConversionTable, "Function"));
         internalField.Append(new SignedField<10>(this, v1));
         internalField.Append(new SignedField<16>(this, v2));
         internalField.Append(new SignedField<16>(this, v3));
@@ -1805,25 +1837,25 @@ class LogicalSwitchField: public TransformedField {
         internalField.Append(new SignedField<8>(this, v1));
         internalField.Append(new SignedField<16>(this, v2));
         internalField.Append(new SignedField<16>(this, v3));
-        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, &functionsConversionTable, "Function"));
+        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, functionsConversionTable, "Function"));
       }
       else if (IS_ARM(board) && version >= 215) {
         internalField.Append(new SignedField<16>(this, v1));
         internalField.Append(new SignedField<16>(this, v2));
-        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, &functionsConversionTable, "Function"));
+        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, functionsConversionTable, "Function"));
       }
       else if (IS_ARM(board)) {
         internalField.Append(new SignedField<8>(this, v1));
         internalField.Append(new SignedField<8>(this, v2));
-        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, &functionsConversionTable, "Function"));
+        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, functionsConversionTable, "Function"));
       }
       else {
         internalField.Append(new SignedField<8>(this, v1));
         internalField.Append(new SignedField<8>(this, v2));
         if (version >= 213)
-          internalField.Append(new ConversionField< UnsignedField<4> >(this, csw.func, &functionsConversionTable, "Function"));
+          internalField.Append(new ConversionField< UnsignedField<4> >(this, csw.func, functionsConversionTable, "Function"));
         else
-          internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, &functionsConversionTable, "Function"));
+          internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, functionsConversionTable, "Function"));
       }
 
       if (IS_ARM(board)) {
@@ -1843,7 +1875,6 @@ class LogicalSwitchField: public TransformedField {
 
     ~LogicalSwitchField()
     {
-      delete andswitchesConversionTable;
     }
 
     virtual void beforeExport()
@@ -1975,7 +2006,7 @@ class LogicalSwitchField: public TransformedField {
     unsigned int version;
     unsigned int variant;
     ModelData * model;
-    LogicalSwitchesFunctionsTable functionsConversionTable;
+    LogicalSwitchesFunctionsTable * functionsConversionTable;
     SourcesConversionTable * sourcesConversionTable;
     SwitchesConversionTable * switchesConversionTable;
     ConversionTable * andswitchesConversionTable;
@@ -2094,8 +2125,36 @@ class CustomFunctionsConversionTable: public ConversionTable {
           addConversion(FuncAdjustGV1+i, val++);
       }
     }
+
+    static CustomFunctionsConversionTable * getInstance(Board::Type board, unsigned int version)
+    {
+      CustomFunctionsConversionTable * table = internalCache.find(board, version);
+      if (!table)
+        table = internalCache.insert(board, version, 0, 0, new CustomFunctionsConversionTable(board, version));
+      return table;
+    }
+
+    static void Cleanup()
+    {
+      internalCache.clear();
+    }
+
+  protected:
+    static ConversionTablesCache<CustomFunctionsConversionTable> internalCache;
 };
 
+ConversionTablesCache<CustomFunctionsConversionTable> CustomFunctionsConversionTable::internalCache;
+
+void OpenTxEepromCleanup(void)
+{
+  SourcesConversionTable::Cleanup();
+  SwitchesConversionTable::Cleanup();
+  TelemetrySourcesConversionTable::Cleanup();
+  LogicalSwitchesFunctionsTable::Cleanup();
+  AndSwitchesConversionTable::Cleanup();
+  CustomFunctionsConversionTable::Cleanup();
+}
+
 template <int N>
 class SwitchesWarningField: public TransformedField {
   public:
@@ -2145,7 +2204,7 @@ class ArmCustomFunctionField: public TransformedField {
       board(board),
       version(version),
       variant(variant),
-      functionsConversionTable(board, version),
+      functionsConversionTable(CustomFunctionsConversionTable::getInstance(board, version)),
       sourcesConversionTable(SourcesConversionTable::getInstance(board, version, variant, version >= 216 ? 0 : FLAG_NONONE)),
       _func(0),
       _active(0),
@@ -2155,11 +2214,11 @@ class ArmCustomFunctionField: public TransformedField {
 
       if (version >= 218) {
         internalField.Append(new SwitchField<9>(this, fn.swtch, board, version));
-        internalField.Append(new ConversionField< UnsignedField<7> >(this, _func, &functionsConversionTable, "Function", DataField::tr("OpenTX on this board doesn't accept this function")));
+        internalField.Append(new ConversionField< UnsignedField<7> >(this, _func, functionsConversionTable, "Function", DataField::tr("OpenTX on this board doesn't accept this function")));
       }
       else {
         internalField.Append(new SwitchField<8>(this, fn.swtch, board, version));
-        internalField.Append(new ConversionField< UnsignedField<8> >(this, _func, &functionsConversionTable, "Function", DataField::tr("OpenTX on this board doesn't accept this function")));
+        internalField.Append(new ConversionField< UnsignedField<8> >(this, _func, functionsConversionTable, "Function", DataField::tr("OpenTX on this board doesn't accept this function")));
       }
 
       if (IS_TARANIS(board) && version >= 216)
@@ -2369,7 +2428,7 @@ class ArmCustomFunctionField: public TransformedField {
     Board::Type board;
     unsigned int version;
     unsigned int variant;
-    CustomFunctionsConversionTable functionsConversionTable;
+    CustomFunctionsConversionTable * functionsConversionTable;
     SourcesConversionTable * sourcesConversionTable;
     unsigned int _func;
     char _param[10];
@@ -2386,7 +2445,7 @@ class AvrCustomFunctionField: public TransformedField {
       board(board),
       version(version),
       variant(variant),
-      functionsConversionTable(board, version),
+      functionsConversionTable(CustomFunctionsConversionTable::getInstance(board, version)),
       sourcesConversionTable(SourcesConversionTable::getInstance(board, version, variant, version >= 216 ? 0 : FLAG_NONONE)),
       _param(0),
       _mode(0),
@@ -2395,7 +2454,7 @@ class AvrCustomFunctionField: public TransformedField {
     {
       if (version >= 217 && IS_2560(board)) {
         internalField.Append(new SwitchField<8>(this, fn.swtch, board, version));
-        internalField.Append(new ConversionField< UnsignedField<8> >(this, (unsigned int &)fn.func, &functionsConversionTable, "Function", DataField::tr("OpenTX on this board doesn't accept this function")));
+        internalField.Append(new ConversionField< UnsignedField<8> >(this, (unsigned int &)fn.func, functionsConversionTable, "Function", DataField::tr("OpenTX on this board doesn't accept this function")));
         internalField.Append(new UnsignedField<2>(this, fn.adjustMode));
         internalField.Append(new UnsignedField<4>(this, _union_param));
         internalField.Append(new UnsignedField<1>(this, _active));
@@ -2403,18 +2462,18 @@ class AvrCustomFunctionField: public TransformedField {
       }
       else if (version >= 216) {
         internalField.Append(new SwitchField<6>(this, fn.swtch, board, version));
-        internalField.Append(new ConversionField< UnsignedField<4> >(this, (unsigned int &)fn.func, &functionsConversionTable, "Function", DataField::tr("OpenTX on this board doesn't accept this function")));
+        internalField.Append(new ConversionField< UnsignedField<4> >(this, (unsigned int &)fn.func, functionsConversionTable, "Function", DataField::tr("OpenTX on this board doesn't accept this function")));
         internalField.Append(new UnsignedField<5>(this, _union_param));
         internalField.Append(new UnsignedField<1>(this, _active));
       }
       else if (version >= 213) {
         internalField.Append(new SwitchField<8>(this, fn.swtch, board, version));
         internalField.Append(new UnsignedField<3>(this, _union_param));
-        internalField.Append(new ConversionField< UnsignedField<5> >(this, (unsigned int &)fn.func, &functionsConversionTable, "Function", DataField::tr("OpenTX on this board doesn't accept this function")));
+        internalField.Append(new ConversionField< UnsignedField<5> >(this, (unsigned int &)fn.func, functionsConversionTable, "Function", DataField::tr("OpenTX on this board doesn't accept this function")));
       }
       else {
         internalField.Append(new SwitchField<8>(this, fn.swtch, board, version));
-        internalField.Append(new ConversionField< UnsignedField<7> >(this, (unsigned int &)fn.func, &functionsConversionTable, "Function", DataField::tr("OpenTX on this board doesn't accept this function")));
+        internalField.Append(new ConversionField< UnsignedField<7> >(this, (unsigned int &)fn.func, functionsConversionTable, "Function", DataField::tr("OpenTX on this board doesn't accept this function")));
         internalField.Append(new BoolField<1>(this, (bool &)fn.enabled));
       }
       internalField.Append(new UnsignedField<8>(this, _param));
@@ -2558,7 +2617,7 @@ class AvrCustomFunctionField: public TransformedField {
     Board::Type board;
     unsigned int version;
     unsigned int variant;
-    CustomFunctionsConversionTable functionsConversionTable;
+    CustomFunctionsConversionTable * functionsConversionTable;
     SourcesConversionTable * sourcesConversionTable;
     unsigned int _param;
     unsigned int _mode;
@@ -2622,7 +2681,7 @@ class FrskyScreenField: public DataField {
       }
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(BitWriter & output)
     {
       if (IS_ARM(board) && version >= 217) {
         if (screen.type == TELEMETRY_SCREEN_SCRIPT)
@@ -2642,7 +2701,7 @@ class FrskyScreenField: public DataField {
       }
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(BitReader & input)
     {
       qCDebug(eepromImport) << QString("importing %1: type: %2").arg(name).arg(screen.type);
 
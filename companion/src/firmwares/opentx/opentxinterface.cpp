@@ -26,6 +26,7 @@
 #include <bitset>
 #include <QMessageBox>
 #include <QTime>
+#include <QElapsedTimer>
 #include <QUrl>
 #include <companion/src/storage/storage.h>
 
@@ -142,7 +143,10 @@ bool OpenTxEepromInterface::saveToByteArray(const T & src, QByteArray & data, ui
   T srcCopy(src); // work on a copy of radio data, because Export() will modify it!
   M manager(srcCopy, board, version, 0);
   // manager.Dump();
+  QElapsedTimer timer;
+  timer.start();
   manager.Export(raw);
+  qCDebug(eepromTiming) << QString("%1: exported %2 bytes in %3us").arg(getName()).arg(raw.size()).arg(timer.nsecsElapsed() / 1000);
   data.resize(8);
   *((uint32_t*)&data.data()[0]) = Boards::getFourCC(board);
   data[4] = version;
@@ -156,9 +160,12 @@ template <class T, class M>
 bool OpenTxEepromInterface::loadFromByteArray(T & dest, const QByteArray & data, uint8_t version, uint32_t variant)
 {
   M manager(dest, board, version, variant);
+  QElapsedTimer timer;
+  timer.start();
   if (manager.Import(data) != 0) {
     return false;
   }
+  qCDebug(eepromTiming) << QString("%1: imported %2 bytes in %3us").arg(getName()).arg(data.size()).arg(timer.nsecsElapsed() / 1000);
   // manager.Dump(); // Dumps the structure so that it's easy to check with firmware datastructs.h
   return true;
 }
@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "logmodel.h"
+
+#define LOG_HOUR_KEY_SIZE  13 // "yyyy-MM-ddHH"
+
+static inline bool isSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+static inline bool isDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+static bool parseDigits(const char * s, int count, int & value)
+{
+  value = 0;
+  for (int i=0; i<count; i++) {
+    if (!isDigit(s[i]))
+      return false;
+    value = value * 10 + (s[i] - '0');
+  }
+  return true;
+}
+
+// Fast path for the plain decimal values found in the logs, other notations are left to Qt
+static bool parseNumber(const char * s, int length, double & value)
+{
+  const char * end = s + length;
+  const char * p = s;
+  bool negative = false;
+  bool digits = false;
+  double result = 0;
+
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = (*p++ == '-');
+  }
+  while (p < end && isDigit(*p)) {
+    result = result * 10 + (*p++ - '0');
+    digits = true;
+  }
+  if (p < end && *p == '.') {
+    double scale = 0.1;
+    for (p++; p < end && isDigit(*p); p++) {
+      result += (*p - '0') * scale;
+      scale /= 10;
+      digits = true;
+    }
+  }
+
+  if (p != end || !digits) {
+    bool ok;
+    value = QByteArray::fromRawData(s, length).toDouble(&ok);
+    return ok;
+  }
+
+  value = negative ? -result : result;
+  return true;
+}
+
+TelemetryLog::TelemetryLog():
+  data(NULL),
+  sorted(true),
+  lines(0),
+  errors(0),
+  lastHourBase(0)
+{
+  lastHourKey.fill(0, LOG_HOUR_KEY_SIZE);
+}
+
+TelemetryLog::~TelemetryLog()
+{
+  clear();
+}
+
+void TelemetryLog::clear()
+{
+  if (data) {
+    file.unmap((uchar *)data);
+    data = NULL;
+  }
+  file.close();
+  header.clear();
+  offsets.clear();
+  lengths.clear();
+  timestamps.clear();
+  columns.clear();
+  pyramids.clear();
+  sorted = true;
+  lines = 0;
+  errors = 0;
+  lastHourKey.fill(0, LOG_HOUR_KEY_SIZE);
+}
+
+bool TelemetryLog::load(const QString & filename)
+{
+  clear();
+
+  file.setFileName(filename);
+  if (!file.open(QIODevice::ReadOnly) || file.size() == 0) {
+    clear();
+    return false;
+  }
+
+  data = (const char *)file.map(0, file.size());
+  if (!data) {
+    clear();
+    return false;
+  }
+
+  const char * end = data + file.size();
+  const char * line = data;
+  QVarLengthArray<const char *, 64> fields;
+  QVarLengthArray<int, 64> fieldsLength;
+  QVector<int> parsed;
+  QVector<int> failed;
+  double lastTimestamp = qQNaN();
+
+  while (line < end) {
+    const char * next = (const char *)memchr(line, '\n', end - line);
+    next = (next ? next + 1 : end);
+
+    // trimmed line
+    const char * start = line;
+    const char * stop = next;
+    while (start < stop && isSpace(*start)) start++;
+    while (stop > start && isSpace(*(stop - 1))) stop--;
+    line = next;
+
+    if (header.isEmpty()) {
+      QString buffer = QString::fromUtf8(start, stop - start);
+      if (!buffer.startsWith("Date,Time")) {
+        clear();
+        return false;
+      }
+      header = buffer.split(',');
+      columns.resize(header.size());
+      parsed.fill(0, header.size());
+      failed.fill(0, header.size());
+      continue;
+    }
+
+    lines++;
+
+    fields.clear();
+    fieldsLength.clear();
+    const char * field = start;
+    for (const char * p = start; p < stop; p++) {
+      if (*p == ',') {
+        fields.append(field);
+        fieldsLength.append(p - field);
+        field = p + 1;
+      }
+    }
+    fields.append(field);
+    fieldsLength.append(stop - field);
+
+    if (fields.size() != header.size()) {
+      errors++;
+      continue;
+    }
+
+    offsets.append(start - data);
+    lengths.append(stop - start);
+    double timestamp = parseTimestamp(fields[0], fieldsLength[0], fields[1], fieldsLength[1]);
+    if (!qIsNaN(timestamp)) {
+      if (timestamp < lastTimestamp) {
+        sorted = false;
+      }
+      lastTimestamp = timestamp;
+    }
+    timestamps.append(timestamp);
+
+    // empty values and values which can't be parsed are read as 0
+    double value;
+    for (int i=2; i<fields.size(); i++) {
+      if (fieldsLength[i] == 0) {
+        columns[i].append(0);
+      }
+      else if (parseNumber(fields[i], fieldsLength[i], value)) {
+        columns[i].append(value);
+        parsed[i]++;
+      }
+      else {
+        columns[i].append(0);
+        failed[i]++;
+      }
+    }
+  }
+
+  // the columns where most of the values are not numbers are kept as text only
+  for (int i=2; i<columns.size(); i++) {
+    if (failed[i] > parsed[i]) {
+      columns[i].clear();
+    }
+  }
+
+  pyramids.resize(columns.size());
+  for (int i=0; i<columns.size(); i++) {
+    buildPyramid(i);
+  }
+
+  return !header.isEmpty();
+}
+
+void TelemetryLog::buildPyramid(int column)
+{
+  const QVector<float> & values = columns.at(column);
+  QVector< QVector<Extrema> > & levels = pyramids[column];
+
+  if (values.size() <= LOG_PYRAMID_BLOCK) {
+    return;
+  }
+
+  QVector<Extrema> level((values.size() + LOG_PYRAMID_BLOCK - 1) / LOG_PYRAMID_BLOCK);
+  for (int i=0; i<level.size(); i++) {
+    int first = i * LOG_PYRAMID_BLOCK;
+    int last = qMin(first + LOG_PYRAMID_BLOCK, values.size());
+    Extrema extrema = { first, first };
+    for (int row = first + 1; row < last; row++) {
+      if (values.at(row) < values.at(extrema.min)) extrema.min = row;
+      if (values.at(row) > values.at(extrema.max)) extrema.max = row;
+    }
+    level[i] = extrema;
+  }
+  levels.append(level);
+
+  while (levels.last().size() > 1) {
+    const QVector<Extrema> & previous = levels.last();
+    QVector<Extrema> level((previous.size() + 1) / 2);
+    for (int i=0; i<level.size(); i++) {
+      Extrema extrema = previous.at(2 * i);
+      if (2 * i + 1 < previous.size()) {
+        const Extrema & next = previous.at(2 * i + 1);
+        if (values.at(next.min) < values.at(extrema.min)) extrema.min = next.min;
+        if (values.at(next.max) > values.at(extrema.max)) extrema.max = next.max;
+      }
+      level[i] = extrema;
+    }
+    levels.append(level);
+  }
+}
+
+TelemetryLog::Extrema TelemetryLog::getExtrema(int column, int first, int last) const
+{
+  const QVector<float> & values = columns.at(column);
+  const QVector< QVector<Extrema> > & levels = pyramids.at(column);
+  Extrema result = { first, first };
+
+  // the range is covered with the largest aligned blocks it contains, the ends are read from the values
+  for (int row = first; row <= last; ) {
+    int level = -1;
+    while (level + 1 < levels.size()) {
+      int size = LOG_PYRAMID_BLOCK << (level + 1);
+      if ((row & (size - 1)) || row + size - 1 > last) break;
+      level++;
+    }
+
+    Extrema extrema = { row, row };
+    if (level < 0) {
+      row++;
+    }
+    else {
+      extrema = levels.at(level).at(row / (LOG_PYRAMID_BLOCK << level));
+      row += LOG_PYRAMID_BLOCK << level;
+    }
+
+    if (values.at(extrema.min) < values.at(result.min)) result.min = extrema.min;
+    if (values.at(extrema.max) > values.at(result.max)) result.max = extrema.max;
+  }
+
+  return result;
+}
+
+int TelemetryLog::findRow(double timestamp) const
+{
+  int low = 0;
+  int high = timestamps.size();
+
+  while (low < high) {
+    int middle = low + (high - low) / 2;
+    int row = middle;
+    while (row < high && qIsNaN(timestamps.at(row))) {
+      row++;
+    }
+    if (row < high && timestamps.at(row) < timestamp)
+      low = row + 1;
+    else
+      high = middle;
+  }
+
+  return low;
+}
+
+void TelemetryLog::decimate(int column, int first, int last, int bucketRows, QVector<double> & x, QVector<double> & y) const
+{
+  const QVector<float> & values = columns.at(column);
+  int lastRow = -1;
+
+  auto addPoint = [&](int row) {
+    if (row != lastRow && !qIsNaN(timestamps.at(row))) {
+      x.append(timestamps.at(row));
+      y.append(values.isEmpty() ? 0 : values.at(row));
+    }
+    lastRow = row;
+  };
+
+  if (first > last) {
+    return;
+  }
+
+  addPoint(first);
+
+  // the non numeric columns are a flat line
+  if (!values.isEmpty()) {
+    bucketRows = qMax(1, bucketRows);
+    for (int row = first; row <= last; row += bucketRows) {
+      Extrema extrema = getExtrema(column, row, qMin(row + bucketRows - 1, last));
+      addPoint(qMin(extrema.min, extrema.max));
+      addPoint(qMax(extrema.min, extrema.max));
+    }
+  }
+
+  addPoint(last);
+}
+
+double TelemetryLog::parseTimestamp(const char * date, int dateLength, const char * time, int timeLength)
+{
+  // "yyyy-MM-dd" and "HH:mm:ss" or "HH:mm:ss.zzz"
+  int minutes, seconds;
+  if (dateLength != 10 || timeLength < 8 || !parseDigits(time + 3, 2, minutes) || !parseDigits(time + 6, 2, seconds)) {
+    return qQNaN();
+  }
+
+  if (memcmp(lastHourKey.constData(), date, 10) || memcmp(lastHourKey.constData() + 10, time, 2)) {
+    int year, month, day, hour;
+    if (!parseDigits(date, 4, year) || !parseDigits(date + 5, 2, month) || !parseDigits(date + 8, 2, day) || !parseDigits(time, 2, hour)) {
+      return qQNaN();
+    }
+    QDateTime dateTime(QDate(year, month, day), QTime(hour, 0));
+    if (!dateTime.isValid()) {
+      return qQNaN();
+    }
+    lastHourBase = dateTime.toTime_t();
+    memcpy(lastHourKey.data(), date, 10);
+    memcpy(lastHourKey.data() + 10, time, 2);
+  }
+
+  double result = lastHourBase + minutes * 60 + seconds;
+  double fraction;
+  if (timeLength > 8 && time[8] == '.' && parseNumber(time + 8, timeLength - 8, fraction)) {
+    result += fraction;
+  }
+  return result;
+}
+
+QDateTime TelemetryLog::getDateTime(int row) const
+{
+  double timestamp = timestamps.at(row);
+  if (qIsNaN(timestamp)) {
+    return QDateTime();
+  }
+  return QDateTime::fromMSecsSinceEpoch(qRound64(timestamp * 1000));
+}
+
+QByteArray TelemetryLog::getLine(int row) const
+{
+  return QByteArray(data + offsets.at(row), lengths.at(row));
+}
+
+QString TelemetryLog::getText(int row, int column) const
+{
+  const char * p = data + offsets.at(row);
+  const char * end = p + lengths.at(row);
+  for (int i=0; i<column && p < end; p++) {
+    if (*p == ',') {
+      i++;
+    }
+  }
+  const char * field = p;
+  while (p < end && *p != ',') {
+    p++;
+  }
+  return QString::fromUtf8(field, p - field);
+}
+
+QStringList TelemetryLog::getRow(int row) const
+{
+  return QString::fromUtf8(data + offsets.at(row), lengths.at(row)).split(',');
+}
+
+TelemetryLogModel::TelemetryLogModel(QObject * parent):
+  QAbstractTableModel(parent)
+{
+}
+
+bool TelemetryLogModel::load(const QString & filename)
+{
+  beginResetModel();
+  bool result = log.load(filename);
+  endResetModel();
+  return result;
+}
+
+int TelemetryLogModel::rowCount(const QModelIndex & parent) const
+{
+  return parent.isValid() ? 0 : log.rowCount();
+}
+
+int TelemetryLogModel::columnCount(const QModelIndex & parent) const
+{
+  return parent.isValid() ? 0 : log.columnCount();
+}
+
+QVariant TelemetryLogModel::data(const QModelIndex & index, int role) const
+{
+  if (!index.isValid() || role != Qt::DisplayRole) {
+    return QVariant();
+  }
+  return log.getText(index.row(), index.column());
+}
+
+QVariant TelemetryLogModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (role != Qt::DisplayRole) {
+    return QVariant();
+  }
+  if (orientation == Qt::Horizontal) {
+    return log.getHeader().value(section);
+  }
+  return section + 1;
+}
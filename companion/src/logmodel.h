@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _LOGMODEL_H_
+#define _LOGMODEL_H_
+
+#include <QtCore>
+#include <QAbstractTableModel>
+
+#define LOG_PYRAMID_BLOCK  8 // rows of the first level of the min / max pyramids
+
+// Telemetry log (CSV) stored by columns: the file is memory mapped and its lines are indexed,
+// the timestamps and the numeric columns are parsed once at load time
+class TelemetryLog
+{
+  public:
+    TelemetryLog();
+    ~TelemetryLog();
+
+    bool load(const QString & filename);
+    void clear();
+
+    int rowCount() const
+    {
+      return offsets.size();
+    }
+
+    int columnCount() const
+    {
+      return header.size();
+    }
+
+    // lines read and invalid lines found during the last load
+    int linesCount() const
+    {
+      return lines;
+    }
+
+    int errorsCount() const
+    {
+      return errors;
+    }
+
+    const QStringList & getHeader() const
+    {
+      return header;
+    }
+
+    QByteArray getLine(int row) const;
+    QString getText(int row, int column) const;
+    QStringList getRow(int row) const;
+
+    // seconds since epoch (with milliseconds), NaN when the date / time can't be parsed
+    const QVector<double> & getTimestamps() const
+    {
+      return timestamps;
+    }
+
+    QDateTime getDateTime(int row) const;
+
+    // empty for the Date / Time columns and for the non numeric ones
+    const QVector<float> & getValues(int column) const
+    {
+      return columns.at(column);
+    }
+
+    // true when the valid timestamps never go backwards, findRow() is only meaningful then
+    bool isSorted() const
+    {
+      return sorted;
+    }
+
+    // first row whose timestamp is not before the given one, the invalid timestamps are skipped
+    int findRow(double timestamp) const;
+
+    // appends the (timestamp, value) points of the rows [first, last] reduced to the min and max
+    // of each bucket of rows, in rows order, plus the first and last rows
+    void decimate(int column, int first, int last, int bucketRows, QVector<double> & x, QVector<double> & y) const;
+
+  protected:
+    // rows of the min / max values of a block of rows
+    struct Extrema {
+      int min;
+      int max;
+    };
+
+    double parseTimestamp(const char * date, int dateLength, const char * time, int timeLength);
+    void buildPyramid(int column);
+    Extrema getExtrema(int column, int first, int last) const;
+
+    QFile file;
+    const char * data;
+    QStringList header;
+    QVector<qint64> offsets;
+    QVector<int> lengths;
+    QVector<double> timestamps;
+    QVector< QVector<float> > columns;
+    // for each numeric column, level n holds the extrema of the blocks of (LOG_PYRAMID_BLOCK << n) rows
+    QVector< QVector< QVector<Extrema> > > pyramids;
+    bool sorted;
+    int lines;
+    int errors;
+
+    // the last hour parsed, the timestamps only need a QDateTime conversion when it changes
+    QByteArray lastHourKey;
+    double lastHourBase;
+};
+
+// Lazy table model over a TelemetryLog, the cells text is extracted only when displayed
+class TelemetryLogModel : public QAbstractTableModel
+{
+  Q_OBJECT
+
+  public:
+    explicit TelemetryLogModel(QObject * parent = NULL);
+
+    bool load(const QString & filename);
+
+    const TelemetryLog & getLog() const
+    {
+      return log;
+    }
+
+    virtual int rowCount(const QModelIndex & parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex & parent = QModelIndex()) const;
+    virtual QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+  protected:
+    TelemetryLog log;
+};
+
+#endif // _LOGMODEL_H_
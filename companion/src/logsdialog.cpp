@@ -19,6 +19,7 @@
  */
 
 #include <math.h>
+#include <algorithm>
 #include "logsdialog.h"
 #include "appdata.h"
 #include "ui_logsdialog.h"
@@ -31,16 +32,16 @@
 
 LogsDialog::LogsDialog(QWidget *parent) :
   QDialog(parent, Qt::WindowTitleHint | Qt::WindowSystemMenuHint),
+  logModel(new TelemetryLogModel(this)),
   ui(new Ui::LogsDialog),
   tracerMaxAlt(0),
   cursorA(0),
   cursorB(0),
   cursorLine(0)
 {
-  csvlog.clear();
-
   ui->setupUi(this);
   setWindowIcon(CompanionIcon("logs.png"));
+  ui->logTable->setModel(logModel);
 
   plotLock=false;
 
@@ -111,12 +112,15 @@ LogsDialog::LogsDialog(QWidget *parent) :
   // make left axes transfer its range to right axes:
   connect(axisRect->axis(QCPAxis::atLeft), SIGNAL(rangeChanged(QCPRange)), this, SLOT(yAxisChangeRanges(QCPRange)));
 
+  // refine the graphs data when zooming / panning:
+  connect(axisRect->axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), this, SLOT(xAxisChangeRange(QCPRange)));
+
   // connect some interaction slots:
   connect(ui->customPlot, SIGNAL(titleDoubleClick(QMouseEvent*, QCPPlotTitle*)), this, SLOT(titleDoubleClick(QMouseEvent*, QCPPlotTitle*)));
   connect(ui->customPlot, SIGNAL(axisDoubleClick(QCPAxis*,QCPAxis::SelectablePart,QMouseEvent*)), this, SLOT(axisLabelDoubleClick(QCPAxis*,QCPAxis::SelectablePart)));
   connect(ui->customPlot, SIGNAL(legendDoubleClick(QCPLegend*,QCPAbstractLegendItem*,QMouseEvent*)), this, SLOT(legendDoubleClick(QCPLegend*,QCPAbstractLegendItem*)));
   connect(ui->FieldsTW, SIGNAL(itemSelectionChanged()), this, SLOT(plotLogs()));
-  connect(ui->logTable, SIGNAL(itemSelectionChanged()), this, SLOT(plotLogs()));
+  connect(ui->logTable->selectionModel(), SIGNAL(selectionChanged(QItemSelection, QItemSelection)), this, SLOT(plotLogs()));
   connect(ui->Reset_PB, SIGNAL(clicked()), this, SLOT(plotLogs()));
   connect(ui->SaveSession_PB, SIGNAL(clicked()), this, SLOT(on_saveSession_BT_clicked()));
 }
@@ -236,18 +240,19 @@ void LogsDialog::selectionChanged()
   }
 }
 
-QList<QStringList> LogsDialog::filterGePoints(const QList<QStringList> & input)
+QList<QStringList> LogsDialog::filterGePoints()
 {
   QList<QStringList> result;
+  const TelemetryLog & log = logModel->getLog();
 
-  int n = input.count();
+  int n = log.rowCount();
   if (n == 0) {
     return result;
   }
 
   int gpscol = 0;
-  for (int i=1; i<input.at(0).count(); i++) {
-    if (input.at(0).at(i) == "GPS") {
+  for (int i=1; i<log.columnCount(); i++) {
+    if (log.getHeader().at(i) == "GPS") {
       gpscol=i;
     }
   }
@@ -258,16 +263,17 @@ The columns for altitude \"GAlt\" and for speed \"GSpd\" are optional"));
     return result;
   }
 
-  result.append(input.at(0));
-  bool rangeSelected = ui->logTable->selectionModel()->selectedRows().length() > 0;
+  result.append(log.getHeader());
+  QItemSelectionModel * selectionModel = ui->logTable->selectionModel();
+  bool rangeSelected = selectionModel->hasSelection();
 
   GpsGlitchFilter glitchFilter;
   GpsLatLonFilter latLonFilter;
 
-  for (int i = 1; i < n; i++) {
-    if ((ui->logTable->item(i-1, 1)->isSelected() && rangeSelected) || !rangeSelected) {
+  for (int i = 0; i < n; i++) {
+    if ((selectionModel->isRowSelected(i, QModelIndex()) && rangeSelected) || !rangeSelected) {
 
-      GpsCoord coord = extractGpsCoordinates(input.at(i).at(gpscol));
+      GpsCoord coord = extractGpsCoordinates(log.getText(i, gpscol));
 
       // glitch filter
       if ( glitchFilter.isGlitch(coord) ) {
@@ -282,18 +288,18 @@ The columns for altitude \"GAlt\" and for speed \"GSpd\" are optional"));
       }
 
       // qDebug() << "point " << latitude << longitude;
-      result.append(input.at(i));
+      result.append(log.getRow(i));
     }
   }
 
-  // qDebug() << "filterGePoints(): filtered from" << input.count() << "to " << result.count() << "points";
+  // qDebug() << "filterGePoints(): filtered from" << n << "to " << result.count() << "points";
   return result;
 }
 
 void LogsDialog::exportToGoogleEarth()
 {
   // filter data points
-  QList<QStringList> dataPoints = filterGePoints(csvlog);
+  QList<QStringList> dataPoints = filterGePoints();
   int n = dataPoints.count(); // number of points to export
   if (n==0) return;
 
@@ -567,6 +573,7 @@ void LogsDialog::removeAllGraphs()
   cursorB = 0;
   cursorLine = 0;
   ui->labelCursors->setText("");
+  plotSources.clear();
 }
 
 void LogsDialog::on_fileOpen_BT_clicked()
@@ -576,37 +583,27 @@ void LogsDialog::on_fileOpen_BT_clicked()
     g.logDir(fileName);
     ui->FileName_LE->setText(fileName);
     if (cvsFileParse()) {
+      const QStringList & header = logModel->getLog().getHeader();
       ui->FieldsTW->clear();
-      ui->logTable->clear();
       ui->FieldsTW->setShowGrid(false);
       ui->FieldsTW->setContentsMargins(0,0,0,0);
-      ui->FieldsTW->setRowCount(csvlog.at(0).count()-2);
+      ui->FieldsTW->setRowCount(header.count()-2);
       ui->FieldsTW->setColumnCount(1);
       ui->FieldsTW->setHorizontalHeaderLabels(QStringList(tr("Available fields")));
       ui->logTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-      for (int i=2; i<csvlog.at(0).count(); i++) {
-        QTableWidgetItem* item= new QTableWidgetItem(csvlog.at(0).at(i));
+      for (int i=2; i<header.count(); i++) {
+        QTableWidgetItem* item= new QTableWidgetItem(header.at(i));
         ui->FieldsTW->setItem(i-2, 0, item);
       }
       ui->FieldsTW->resizeRowsToContents();
-      ui->logTable->setColumnCount(csvlog.at(0).count());
-      ui->logTable->setRowCount(csvlog.count()-1);
-      ui->logTable->setHorizontalHeaderLabels(csvlog.at(0));
-
-      QAbstractItemModel *model = ui->logTable->model();
-      for (int i=1; i<csvlog.count(); i++) {
-        for (int j=0; j<csvlog.at(0).count(); j++) {
-          model->setData(model->index(i - 1, j, QModelIndex()), csvlog.at(i).at(j));
-        }
-      }
 
       ui->logTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
       QVarLengthArray<int> sizes;
-      for (int i = 0; i < ui->logTable->columnCount(); i++) {
+      for (int i = 0; i < logModel->columnCount(); i++) {
         sizes.append(ui->logTable->columnWidth(i));
       }
       ui->logTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
-      for (int i = 0; i < ui->logTable->columnCount(); i++) {
+      for (int i = 0; i < logModel->columnCount(); i++) {
         ui->logTable->setColumnWidth(i, sizes.at(i));
       }
     }
@@ -618,14 +615,15 @@ void LogsDialog::on_saveSession_BT_clicked()
   int index = ui->sessions_CB->currentIndex();
   // ignore index 0 is its all sessions combined
   if(index > 0) {
-    int n = csvlog.count();
-    QList<QStringList> sessionCsvLog;
+    const TelemetryLog & log = logModel->getLog();
+    int n = log.rowCount();
+    QList<QByteArray> sessionCsvLog;
     // add CSV headers from first row of source file
-    sessionCsvLog.push_back(csvlog[0]);
+    sessionCsvLog.push_back(log.getHeader().join(",").toUtf8());
     // find session breaks
     int currentSession = 0;
     QDateTime lastvalue;
-    for (int i = 1; i < n; i++) {
+    for (int i = 0; i < n; i++) {
       QDateTime tmp = getRecordTimeStamp(i);
       if (!lastvalue.isValid() || lastvalue.secsTo(tmp) > 60) {
         currentSession++;
@@ -633,7 +631,7 @@ void LogsDialog::on_saveSession_BT_clicked()
       lastvalue = tmp;
       if(currentSession == index) {
         // add records to filtered list
-        sessionCsvLog.push_back(csvlog[i]);
+        sessionCsvLog.push_back(log.getLine(i));
       }
       else if (currentSession > index) {
         break;
@@ -648,7 +646,7 @@ void LogsDialog::on_saveSession_BT_clicked()
       QTextStream output(&data);
       int numRecords = sessionCsvLog.count();
       for(int i = 0; i < numRecords; i++){
-        output << sessionCsvLog[i].join(",") << '\n';
+        output << sessionCsvLog[i] << '\n';
       }
     }
     sessionCsvLog.clear();
@@ -657,53 +655,21 @@ void LogsDialog::on_saveSession_BT_clicked()
 
 bool LogsDialog::cvsFileParse()
 {
-  QFile file(ui->FileName_LE->text());
-  int errors=0;
-  int lines=-1;
+  logFilename.clear();
 
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) { // reading HEX TEXT file
+  // the file is memory mapped, the numeric columns and the timestamps are parsed once here
+  if (!logModel->load(ui->FileName_LE->text())) {
     return false;
   }
-  else {
-    csvlog.clear();
-    logFilename.clear();
-    QTextStream inputStream(&file);
-    QString buffer = file.readLine();
-
-    if (buffer.startsWith("Date,Time")) {
-      file.reset();
-    }
-    else {
-      return false;
-    }
-
-    int numfields=-1;
-    while (!file.atEnd()) {
-      QString line = file.readLine().trimmed();
-      QStringList columns = line.split(',');
-      if (numfields==-1) {
-        numfields=columns.count();
-      }
-      if (columns.count()==numfields) {
-        csvlog.append(columns);
-      }
-      else {
-        errors++;
-      }
-      lines++;
-    }
 
-    logFilename = QFileInfo(file.fileName()).baseName();
-  }
+  logFilename = QFileInfo(ui->FileName_LE->text()).baseName();
 
-  file.close();
-  if (errors > 1) {
-    QMessageBox::warning(this, CPN_STR_APP_NAME, tr("The selected logfile contains %1 invalid lines out of  %2 total lines").arg(errors).arg(lines));
+  const TelemetryLog & log = logModel->getLog();
+  if (log.errorsCount() > 1) {
+    QMessageBox::warning(this, CPN_STR_APP_NAME, tr("The selected logfile contains %1 invalid lines out of  %2 total lines").arg(log.errorsCount()).arg(log.linesCount()));
   }
 
-  int n = csvlog.count();
-  if (n == 1) {
-    csvlog.clear();
+  if (log.rowCount() == 0) {
     return false;
   }
 
@@ -719,12 +685,9 @@ struct FlightSession {
   QDateTime end;
 };
 
-QDateTime LogsDialog::getRecordTimeStamp(int index)
+QDateTime LogsDialog::getRecordTimeStamp(int row)
 {
-  QString tstamp = csvlog.at(index).at(0) + " " + csvlog.at(index).at(1);
-  if (csvlog.at(index).at(1).contains("."))
-    return QDateTime::fromString(tstamp, "yyyy-MM-dd HH:mm:ss.zzz");
-  return QDateTime::fromString(tstamp, "yyyy-MM-dd HH:mm:ss");
+  return logModel->getLog().getDateTime(row);
 }
 
 QString LogsDialog::generateDuration(const QDateTime & start, const QDateTime & end)
@@ -744,35 +707,35 @@ void LogsDialog::setFlightSessions()
   ui->sessions_CB->clear();
   ui->SaveSession_PB->setEnabled(false);
 
-  int n = csvlog.count();
+  int n = logModel->rowCount();
   // qDebug() << "records" << n;
 
   // find session breaks
   QList<int> sessions;
   QDateTime lastvalue;
-  for (int i = 1; i < n; i++) {
+  for (int i = 0; i < n; i++) {
     QDateTime tmp = getRecordTimeStamp(i);
     if (!lastvalue.isValid() || lastvalue.secsTo(tmp) > 60) {
-      sessions.push_back(i-1);
-      // qDebug() << "session index" << i-1;
+      sessions.push_back(i);
+      // qDebug() << "session index" << i;
     }
     lastvalue = tmp;
   }
-  sessions.push_back(n-1);
+  sessions.push_back(n);
 
   //now construct a list of sessions with their times
   //total time
   int noSesions = sessions.size()-1;
   QString label = QString("%1 ").arg(noSesions);
   label += tr(noSesions > 1 ? "sessions" : "session");
-  label += " <" + tr("total duration ") + generateDuration(getRecordTimeStamp(1), getRecordTimeStamp(n-1)) + ">";
+  label += " <" + tr("total duration ") + generateDuration(getRecordTimeStamp(0), getRecordTimeStamp(n-1)) + ">";
   ui->sessions_CB->addItem(label);
 
   // add individual sessions
   if (sessions.size() > 2) {
     for (int i = 1; i < sessions.size(); i++) {
-      QDateTime sessionStart = getRecordTimeStamp(sessions.at(i-1)+1);
-      QDateTime sessionEnd = getRecordTimeStamp(sessions.at(i));
+      QDateTime sessionStart = getRecordTimeStamp(sessions.at(i-1));
+      QDateTime sessionEnd = getRecordTimeStamp(sessions.at(i)-1);
       QString label = sessionStart.toString("HH:mm:ss") + " <" + tr("duration ") + generateDuration(sessionStart, sessionEnd) + ">";
       ui->sessions_CB->addItem(label, sessions.at(i-1));
       // qDebug() << "added label" << label << sessions.at(i-1);
@@ -792,13 +755,13 @@ void LogsDialog::on_sessions_CB_currentIndexChanged(int index)
     if (index < ui->sessions_CB->count() - 1) {
       bottom = ui->sessions_CB->itemData(index + 1, Qt::UserRole).toInt();
     } else {
-      bottom = ui->logTable->rowCount();
+      bottom = logModel->rowCount();
     }
 
-    QModelIndex topLeft = ui->logTable->model()->index(
+    QModelIndex topLeft = logModel->index(
       ui->sessions_CB->itemData(index, Qt::UserRole).toInt(), 0 , QModelIndex());
-    QModelIndex bottomRight = ui->logTable->model()->index(
-      bottom - 1, ui->logTable->columnCount() - 1, QModelIndex());
+    QModelIndex bottomRight = logModel->index(
+      bottom - 1, logModel->columnCount() - 1, QModelIndex());
 
     QItemSelection selection(topLeft, bottomRight);
     ui->logTable->selectionModel()->select(selection, QItemSelectionModel::Select);
@@ -823,21 +786,22 @@ void LogsDialog::plotLogs()
   }
 
   plotsCollection plots;
+  QVector<plotSource_t> sources;
 
-  QModelIndexList selection = ui->logTable->selectionModel()->selectedRows();
-  int rowCount = selection.length();
-  bool hasLogSelection;
-  QVarLengthArray<int> selectedRows;
-
-  if (rowCount) {
-    hasLogSelection = true;
-    foreach (QModelIndex index, selection) {
-      selectedRows.append(index.row());
+  // the selection ranges are used directly, a whole session may hold a million rows
+  plotRanges.clear();
+  foreach (const QItemSelectionRange & range, ui->logTable->selectionModel()->selection()) {
+    plotRanges.append(qMakePair(range.top(), range.bottom()));
+  }
+  std::sort(plotRanges.begin(), plotRanges.end());
+  for (int i = plotRanges.size() - 1; i > 0; i--) {
+    if (plotRanges.at(i).first <= plotRanges.at(i - 1).second + 1) {
+      plotRanges[i - 1].second = qMax(plotRanges.at(i - 1).second, plotRanges.at(i).second);
+      plotRanges.remove(i);
     }
-    qSort(selectedRows.begin(), selectedRows.end());
-  } else {
-    hasLogSelection = false;
-    rowCount = ui->logTable->rowCount();
+  }
+  if (plotRanges.isEmpty() && logModel->getLog().rowCount() > 0) {
+    plotRanges.append(qMakePair(0, logModel->getLog().rowCount() - 1));
   }
 
   plots.min_x = QDateTime::currentDateTime().toTime_t();
@@ -845,45 +809,27 @@ void LogsDialog::plotLogs()
 
   foreach (QTableWidgetItem *plot, ui->FieldsTW->selectedItems()) {
     coords_t plotCoords;
-    int plotColumn = plot->row() + 2; // Date and Time first
+    plotSource_t plotSource;
+
+    plotSource.column = plot->row() + 2; // Date and Time first
+    plotSource.offset = 0;
+    plotSource.factor = 1;
 
     plotCoords.min_y = INVALID_MIN;
     plotCoords.max_y = INVALID_MAX;
     plotCoords.yaxis = firstLeft;
     plotCoords.name = plot->text();
 
-    for (int row = 0; row < rowCount; row++) {
-      QTableWidgetItem *logValue;
-      double y;
-      double time;
-      QString time_str;
-
-      if (hasLogSelection) {
-        logValue = ui->logTable->item(selectedRows.at(row), plotColumn);
-        time_str = ui->logTable->item(selectedRows.at(row), 0)->text() +
-          QString(" ") + ui->logTable->item(selectedRows.at(row), 1)->text();
-      } else {
-        logValue = ui->logTable->item(row, plotColumn);
-        time_str = ui->logTable->item(row, 0)->text() + QString(" ") +
-          ui->logTable->item(row, 1)->text();
-      }
+    // the decimation keeps the min and max of the rows, so the limits are the same as with all the rows
+    decimatePlot(plotSource, plotRanges, plotCoords.x, plotCoords.y);
 
-      y = logValue->text().toDouble();
-      plotCoords.y.push_back(y);
+    for (int i = 0; i < plotCoords.x.size(); i++) {
+      double y = plotCoords.y.at(i);
+      double time = plotCoords.x.at(i);
 
       if (plotCoords.min_y > y) plotCoords.min_y = y;
       if (plotCoords.max_y < y) plotCoords.max_y = y;
 
-      if (time_str.contains('.')) {
-        time = QDateTime::fromString(time_str, "yyyy-MM-dd HH:mm:ss.zzz")
-          .toTime_t();
-        time += time_str.mid(time_str.indexOf('.')).toDouble();
-      } else {
-        time = QDateTime::fromString(time_str, "yyyy-MM-dd HH:mm:ss")
-          .toTime_t();
-      }
-      plotCoords.x.push_back(time);
-
       if (plots.min_x > time) plots.min_x = time;
       if (plots.max_x < time) plots.max_x = time;
     }
@@ -894,6 +840,7 @@ void LogsDialog::plotLogs()
     plotCoords.min_y -= range_inc;
 
     plots.coords.append(plotCoords);
+    sources.append(plotSource);
   }
 
   yAxesRanges[firstLeft].min = plots.coords.at(0).min_y;
@@ -962,6 +909,8 @@ void LogsDialog::plotLogs()
       plots.coords[i].yaxis = firstLeft;
 
       double factor = 100 / (plots.coords.at(i).max_y - plots.coords.at(i).min_y);
+      sources[i].offset = plots.coords.at(i).min_y;
+      sources[i].factor = factor;
       for (int j = 0; j < plots.coords.at(i).y.count(); j++) {
         plots.coords[i].y[j] = factor * (plots.coords.at(i).y.at(j) - plots.coords.at(i).min_y);
       }
@@ -1066,10 +1015,65 @@ void LogsDialog::plotLogs()
     }
   }
 
+  plotSources = sources;
+
   ui->customPlot->legend->setVisible(true);
   ui->customPlot->replot();
 }
 
+void LogsDialog::decimatePlot(const plotSource_t & source, const QVector< QPair<int, int> > & ranges, QVector<double> & x, QVector<double> & y)
+{
+  const TelemetryLog & log = logModel->getLog();
+
+  // about one min / max pair of points per pixel
+  int rowCount = 0;
+  for (int i = 0; i < ranges.size(); i++) {
+    rowCount += ranges.at(i).second - ranges.at(i).first + 1;
+  }
+  int bucketRows = rowCount / qMax(axisRect->width(), 100);
+
+  x.clear();
+  y.clear();
+  for (int i = 0; i < ranges.size(); i++) {
+    log.decimate(source.column, ranges.at(i).first, ranges.at(i).second, bucketRows, x, y);
+  }
+
+  if (source.factor != 1 || source.offset != 0) {
+    for (int i = 0; i < y.size(); i++) {
+      y[i] = source.factor * (y.at(i) - source.offset);
+    }
+  }
+}
+
+void LogsDialog::xAxisChangeRange(QCPRange range)
+{
+  if (plotSources.isEmpty()) return;
+
+  const TelemetryLog & log = logModel->getLog();
+  QVector< QPair<int, int> > visibleRanges;
+
+  // one more row on each side for the lines to reach the plot borders
+  if (log.isSorted()) {
+    int first = log.findRow(range.lower) - 1;
+    int last = log.findRow(range.upper);
+    for (int i = 0; i < plotRanges.size(); i++) {
+      QPair<int, int> visible(qMax(first, plotRanges.at(i).first), qMin(last, plotRanges.at(i).second));
+      if (visible.first <= visible.second) {
+        visibleRanges.append(visible);
+      }
+    }
+  }
+  else {
+    visibleRanges = plotRanges;
+  }
+
+  QVector<double> x, y;
+  for (int i = 0; i < plotSources.size() && i < ui->customPlot->graphCount(); i++) {
+    decimatePlot(plotSources.at(i), visibleRanges, x, y);
+    ui->customPlot->graph(i)->setData(x, y);
+  }
+}
+
 void LogsDialog::yAxisChangeRanges(QCPRange range)
 {
   if (axisRect->axis(QCPAxis::atRight)->visible()) {
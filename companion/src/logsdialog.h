@@ -24,6 +24,7 @@
 #include <QtCore>
 #include <QDialog>
 #include "qcustomplot.h"
+#include "logmodel.h"
 
 #define INVALID_MIN 999999
 #define INVALID_MAX -999999
@@ -52,6 +53,13 @@ class LogsDialog : public QDialog
     QString name;
   };
 
+  // a plotted column, its values are rescaled as y = factor * (value - offset)
+  struct plotSource_t {
+    int column;
+    double offset;
+    double factor;
+  };
+
   struct minMax_t {
     double min;
     double max;
@@ -82,9 +90,10 @@ private slots:
   void on_sessions_CB_currentIndexChanged(int index);
   void on_mapsButton_clicked();
   void yAxisChangeRanges(QCPRange range);
+  void xAxisChangeRange(QCPRange range);
 
 private:
-  QList<QStringList> csvlog;
+  TelemetryLogModel *logModel;
   Ui::LogsDialog *ui;
   QCPAxisRect *axisRect;
   QCPLegend *rightLegend;
@@ -102,12 +111,17 @@ private:
   QCPItemTracer * cursorB;
   QCPItemStraightLine * cursorLine;
 
+  // rows and columns of the graphs, their data is decimated to the visible range
+  QVector< QPair<int, int> > plotRanges;
+  QVector<plotSource_t> plotSources;
+
   bool cvsFileParse();
-  QList<QStringList> filterGePoints(const QList<QStringList> & input);
+  QList<QStringList> filterGePoints();
   void exportToGoogleEarth();
-  QDateTime getRecordTimeStamp(int index);
+  QDateTime getRecordTimeStamp(int row);
   QString generateDuration(const QDateTime & start, const QDateTime & end);
   void setFlightSessions();
+  void decimatePlot(const plotSource_t & source, const QVector< QPair<int, int> > & ranges, QVector<double> & x, QVector<double> & y);
 
   void addMaxAltitudeMarker(const coords_t & c, QCPGraph * graph);
   void countNumberOfThrows(const coords_t & c, QCPGraph * graph);
@@ -34,6 +34,7 @@
 #include "radiodataconversionstate.h"
 
 #include <algorithm>
+#include <QProgressDialog>
 #include <ExportableTableView>
 
 MdiChild::MdiChild(QWidget * parent, QWidget * parentWin, Qt::WindowFlags f):
@@ -1319,6 +1320,12 @@ void MdiChild::newFile(bool createDefaults)
 bool MdiChild::loadFile(const QString & filename, bool resetCurrentFile)
 {
   Storage storage(filename);
+  QProgressDialog progress(tr("Loading models..."), QString(), 0, 0, this);
+  progress.setWindowModality(Qt::WindowModal);
+  connect(&storage, &Storage::progress, [&progress](int value, int maximum) {
+    progress.setMaximum(maximum);
+    progress.setValue(value);
+  });
   if (!storage.load(radioData)) {
     QMessageBox::critical(this, CPN_STR_TTL_ERROR, storage.error());
     return false;
@@ -1377,6 +1384,12 @@ bool MdiChild::saveFile(const QString & filename, bool setCurrent)
 {
   radioData.fixModelFilenames();
   Storage storage(filename);
+  QProgressDialog progress(tr("Saving models..."), QString(), 0, 0, this);
+  progress.setWindowModality(Qt::WindowModal);
+  connect(&storage, &Storage::progress, [&progress](int value, int maximum) {
+    progress.setMaximum(maximum);
+    progress.setValue(value);
+  });
   bool result = storage.write(radioData);
   if (!result) {
     return false;
@@ -21,6 +21,64 @@
 #include "categorized.h"
 #include "firmwares/opentx/opentxinterface.h"
 
+#define PROGRESS_INTERVAL   100 // ms
+
+class CategorizedStorageTask : public QRunnable
+{
+  public:
+    CategorizedStorageTask(const std::function<void()> & function, QAtomicInt & done):
+      function(function),
+      done(done)
+    {
+    }
+
+    virtual void run()
+    {
+      function();
+      done.ref();
+    }
+
+  protected:
+    std::function<void()> function;
+    QAtomicInt & done;
+};
+
+void CategorizedStorageFormat::runTasks(const std::vector<std::function<void()>> & tasks)
+{
+  QThreadPool pool;
+  QAtomicInt done;
+  int count = tasks.size();
+
+  for (int i=0; i<count; i++) {
+    pool.start(new CategorizedStorageTask(tasks[i], done));
+  }
+
+  while (!pool.waitForDone(PROGRESS_INTERVAL)) {
+    emit progress(done.load(), count);
+  }
+
+  emit progress(count, count);
+}
+
+bool CategorizedStorageFormat::writeFiles(const QStringList & fileNames, const QList<QByteArray> & filesData)
+{
+  for (int i=0; i<fileNames.size(); i++) {
+    if (!writeFile(filesData[i], fileNames[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+struct CategorizedModelFile
+{
+  int index;
+  int category;
+  QString fileName;
+  QByteArray data;
+  bool loaded;
+};
+
 bool CategorizedStorageFormat::load(RadioData & radioData)
 {
   QByteArray radioSettingsBuffer;
@@ -42,6 +100,8 @@ bool CategorizedStorageFormat::load(RadioData & radioData)
     return false;
   }
 
+  // the files are extracted in the models.txt order, they are decoded in parallel afterwards
+  std::vector<CategorizedModelFile> modelFiles;
   QList<QByteArray> lines = modelsListBuffer.split('\n');
   int modelIndex = 0;
   int categoryIndex = -1;
@@ -80,27 +140,15 @@ bool CategorizedStorageFormat::load(RadioData & radioData)
       // parse model file name and load
       QString fileName = parts[0];
       qDebug() << "Loading model from file" << fileName << "into slot" << modelIndex;
-      QByteArray modelBuffer;
-      if (!loadFile(modelBuffer, QString("MODELS/%1").arg(fileName))) {
+      CategorizedModelFile modelFile = { modelIndex, categoryIndex, fileName, QByteArray(), false };
+      if (!loadFile(modelFile.data, QString("MODELS/%1").arg(fileName))) {
         setError(tr("Can't extract %1").arg(fileName));
         return false;
       }
       if ((int)radioData.models.size() <= modelIndex) {
         radioData.models.resize(modelIndex + 1);
       }
-      if (!loadModelFromByteArray(radioData.models[modelIndex], modelBuffer)) {
-        setError(tr("Error loading models"));
-        return false;
-      }
-      strncpy(radioData.models[modelIndex].filename, qPrintable(fileName), sizeof(radioData.models[modelIndex].filename));
-      if (IS_HORUS(board) && !strcmp(radioData.generalSettings.currModelFilename, qPrintable(fileName))) {
-        radioData.generalSettings.currModelIndex = modelIndex;
-        qDebug() << "currModelIndex =" << modelIndex;
-      }
-      if (getCurrentFirmware()->getCapability(HasModelCategories)) {
-        radioData.models[modelIndex].category = categoryIndex;
-      }
-      radioData.models[modelIndex].used = true;
+      modelFiles.push_back(modelFile);
       modelIndex++;
       continue;
     }
@@ -110,6 +158,36 @@ bool CategorizedStorageFormat::load(RadioData & radioData)
     qDebug() << "Invalid line" <<line;
     continue;
   }
+
+  // each task decodes its own model file into its own slot, radioData.models is not resized anymore
+  std::vector<std::function<void()>> tasks;
+  for (unsigned int i=0; i<modelFiles.size(); i++) {
+    CategorizedModelFile * modelFile = &modelFiles[i];
+    ModelData * model = &radioData.models[modelFile->index];
+    tasks.push_back([modelFile, model]() {
+      modelFile->loaded = (loadModelFromByteArray(*model, modelFile->data) != NULL);
+    });
+  }
+  runTasks(tasks);
+
+  for (unsigned int i=0; i<modelFiles.size(); i++) {
+    const CategorizedModelFile & modelFile = modelFiles[i];
+    ModelData & model = radioData.models[modelFile.index];
+    if (!modelFile.loaded) {
+      setError(tr("Error loading models"));
+      return false;
+    }
+    strncpy(model.filename, qPrintable(modelFile.fileName), sizeof(model.filename));
+    if (IS_HORUS(board) && !strcmp(radioData.generalSettings.currModelFilename, qPrintable(modelFile.fileName))) {
+      radioData.generalSettings.currModelIndex = modelFile.index;
+      qDebug() << "currModelIndex =" << modelFile.index;
+    }
+    if (getCurrentFirmware()->getCapability(HasModelCategories)) {
+      model.category = modelFile.category;
+    }
+    model.used = true;
+  }
+
   return true;
 }
 
@@ -126,16 +204,27 @@ bool CategorizedStorageFormat::write(const RadioData & radioData)
     return false;
   }
 
+  // the models are encoded in parallel, then written in their slots order
+  std::vector<QByteArray> modelsData(numModels);
+  std::vector<std::function<void()>> tasks;
+  for (size_t m=0; m<numModels; m++) {
+    if (radioData.models[m].isEmpty()) continue;
+    const ModelData * model = &radioData.models[m];
+    QByteArray * modelData = &modelsData[m];
+    tasks.push_back([model, modelData]() {
+      writeModelToByteArray(*model, *modelData);
+    });
+  }
+  runTasks(tasks);
+
+  QStringList modelsFilenames;
+  QList<QByteArray> modelsFilesData;
   for (size_t m=0; m<numModels; m++) {
     const ModelData & model = radioData.models[m];
     if (model.isEmpty()) continue;
 
-    QString modelFilename = QString("MODELS/%1").arg(model.filename);
-    QByteArray modelData;
-    writeModelToByteArray(model, modelData);
-    if (!writeFile(modelData, modelFilename)) {
-      return false;
-    }
+    modelsFilenames.append(QString("MODELS/%1").arg(model.filename));
+    modelsFilesData.append(modelsData[m]);
 
     // For firmware that doesn't support categories, we can just construct
     // models.txt as we iterate thru the models vector. For firmware that does
@@ -151,6 +240,10 @@ bool CategorizedStorageFormat::write(const RadioData & radioData)
     }
   }
 
+  if (!writeFiles(modelsFilenames, modelsFilesData)) {
+    return false;
+  }
+
   if (getCurrentFirmware()->getCapability(HasModelCategories)) {
     for (size_t c=0; c<numCategories; c++) {
       modelsList.append(QString().sprintf("[%s]\n", radioData.categories[c].name));
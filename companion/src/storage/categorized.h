@@ -24,6 +24,7 @@
 #include "storage.h"
 
 #include <QtCore>
+#include <functional>
 
 class CategorizedStorageFormat : public StorageFormat
 {
@@ -41,6 +42,10 @@ class CategorizedStorageFormat : public StorageFormat
   protected:
     virtual bool loadFile(QByteArray & fileData, const QString & fileName) = 0;
     virtual bool writeFile(const QByteArray & fileData, const QString & fileName) = 0;
+    virtual bool writeFiles(const QStringList & fileNames, const QList<QByteArray> & filesData);
+
+    // runs independent tasks (one per model) in a thread pool, the progress is reported while waiting for them
+    void runTasks(const std::vector<std::function<void()>> & tasks);
 };
 
 #endif // _CATEGORIZED_H_
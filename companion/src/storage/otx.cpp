@@ -114,3 +114,43 @@ bool OtxFormat::writeFile(const QByteArray & filedata, const QString & filename)
 
   return true;
 }
+
+struct OtxCompressedFile
+{
+  void * data;
+  size_t size;
+  mz_uint32 crc;
+};
+
+bool OtxFormat::writeFiles(const QStringList & filenames, const QList<QByteArray> & filesdata)
+{
+  // the entries are deflated in parallel, then added to the archive in order
+  int count = filesdata.size();
+  std::vector<OtxCompressedFile> compressedFiles(count);
+  std::vector<std::function<void()>> tasks;
+  for (int i=0; i<count; i++) {
+    const QByteArray * filedata = &filesdata[i];
+    OtxCompressedFile * compressedFile = &compressedFiles[i];
+    tasks.push_back([filedata, compressedFile]() {
+      compressedFile->crc = (mz_uint32)mz_crc32(MZ_CRC32_INIT, (const mz_uint8 *)filedata->constData(), filedata->size());
+      compressedFile->data = tdefl_compress_mem_to_heap(filedata->constData(), filedata->size(), &compressedFile->size,
+                                                        tdefl_create_comp_flags_from_zip_params(MZ_DEFAULT_LEVEL, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY));
+    });
+  }
+  runTasks(tasks);
+
+  bool result = true;
+  for (int i=0; i<count; i++) {
+    OtxCompressedFile & compressedFile = compressedFiles[i];
+    if (result) {
+      if (!compressedFile.data || !mz_zip_writer_add_mem_ex(&zip_archive, filenames[i].toStdString().c_str(), compressedFile.data, compressedFile.size, NULL, 0,
+                                                            MZ_DEFAULT_LEVEL | MZ_ZIP_FLAG_COMPRESSED_DATA, filesdata[i].size(), compressedFile.crc)) {
+        setError(tr("Error adding %1 to OTX archive").arg(filenames[i]));
+        result = false;
+      }
+    }
+    mz_free(compressedFile.data);
+  }
+
+  return result;
+}
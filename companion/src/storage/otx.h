@@ -46,6 +46,7 @@ class OtxFormat : public CategorizedStorageFormat
   protected:
     virtual bool loadFile(QByteArray & fileData, const QString & fileName);
     virtual bool writeFile(const QByteArray & fileData, const QString & fileName);
+    virtual bool writeFiles(const QStringList & fileNames, const QList<QByteArray> & filesData);
 
     mz_zip_archive zip_archive;
 };
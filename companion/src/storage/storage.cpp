@@ -81,6 +81,7 @@ bool Storage::load(RadioData & radioData)
   bool ret = false;
   foreach(StorageFactory * factory, registeredStorageFactories) {
     StorageFormat * format = factory->instance(filename);
+    connect(format, &StorageFormat::progress, this, &StorageFormat::progress);
     if (format->load(radioData)) {
       board = format->getBoard();
       setWarning(format->warning());
@@ -102,6 +103,7 @@ bool Storage::write(const RadioData & radioData)
   foreach(StorageFactory * factory, registeredStorageFactories) {
     if (factory->probe(filename)) {
       StorageFormat * format = factory->instance(filename);
+      connect(format, &StorageFormat::progress, this, &StorageFormat::progress);
       ret = format->write(radioData);
       delete format;
       break;
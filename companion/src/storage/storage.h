@@ -41,9 +41,9 @@ enum StorageType
 
 StorageType getStorageType(const QString & filename);
 
-class StorageFormat
+class StorageFormat : public QObject
 {
-  Q_DECLARE_TR_FUNCTIONS(StorageFormat)
+  Q_OBJECT
 
   public:
     StorageFormat(const QString & filename, uint8_t version=0):
@@ -71,6 +71,9 @@ class StorageFormat
       return board;
     }
 
+  signals:
+    void progress(int value, int maximum);
+
   protected:
     void setError(const QString & error)
     {
@@ -488,14 +488,17 @@ const int16_t ulawTable[256] = { -32124, -31100, -30076, -29052, -28028, -27004,
 
 AudioQueue audioQueue __DMA;      // to place it in the RAM section on Horus, to have file buffers in RAM for DMA access
 AudioBuffer audioBuffers[AUDIO_BUFFER_COUNT] __DMA;
+AudioStats audioStats;
 
 AudioQueue::AudioQueue()
   : buffersFifo(),
   _started(false),
+  playing(false),
   normalContext(),
   backgroundContext(),
   priorityContext(),
   varioContext(),
+  prefetchContext(),
   fragmentsFifo()
 {
 }
@@ -525,16 +528,109 @@ void audioTask(void * pdata)
   while (1) {
     DEBUG_TIMER_SAMPLE(debugTimerAudioIterval);
     DEBUG_TIMER_START(debugTimerAudioDuration);
-    audioQueue.wakeup();
+    {
+      ProfilerTaskScope scope(PROFILER_TASK_AUDIO);
+      audioQueue.wakeup();
+    }
     DEBUG_TIMER_STOP(debugTimerAudioDuration);
     CoTickDelay(2/*4ms*/);
   }
 }
 #endif
 
-inline void mixSample(audio_data_t * result, int sample, unsigned int fade)
+#define MIX_DELTA(sample, gain)  ((int32_t(sample) * (gain)) >> (AUDIO_GAIN_SHIFT+16-AUDIO_BITS_PER_SAMPLE))
+#define SINE_PHASE_PERIOD        (DIM(sineValues) << 16)
+
+#if defined(__ARM_FEATURE_DSP)
+  // two samples at once with the Cortex-M4 SIMD instructions
+  #if defined(PCBX12S)
+    #define MIX_SADD16(a, b)     __SADD16(a, b)
+  #else
+    #define MIX_SADD16(a, b)     __USAT16(__SADD16(a, b), AUDIO_BITS_PER_SAMPLE)
+  #endif
+  #define MIX_PAIR(d0, d1)       (uint16_t(d0) | (uint32_t(uint16_t(d1)) << 16))
+#endif
+
+inline void mixDelta(audio_data_t * result, int delta)
+{
+  *result = limit<int>(AUDIO_DATA_MIN, *result + delta, AUDIO_DATA_MAX);
+}
+
+// the speaker volume is part of the gain of each context, instead of a pass over the mixed buffer
+inline int mixGain(int gain)
+{
+#if defined(SOFTWARE_VOLUME)
+  return gain * min<int>(currentSpeakerVolume, VOLUME_LEVEL_MAX) / VOLUME_LEVEL_MAX;
+#else
+  return gain;
+#endif
+}
+
+void mixSamples(audio_data_t * result, const int16_t * samples, unsigned int count, unsigned int ratio, int gain)
+{
+#if defined(MIX_SADD16)
+  if (((uintptr_t)result & 3) == 0) {
+    uint32_t * words = (uint32_t *)result;
+    if (ratio == 1) {
+      for (; count >= 2; count -= 2) {
+        *words = MIX_SADD16(*words, MIX_PAIR(MIX_DELTA(samples[0], gain), MIX_DELTA(samples[1], gain)));
+        words++;
+        samples += 2;
+      }
+    }
+    else if ((ratio & 1) == 0) {
+      for (; count > 0; count--) {
+        int delta = MIX_DELTA(*samples++, gain);
+        uint32_t pair = MIX_PAIR(delta, delta);
+        for (unsigned int j=0; j<ratio; j+=2) {
+          *words = MIX_SADD16(*words, pair);
+          words++;
+        }
+      }
+    }
+    result = (audio_data_t *)words;
+  }
+#endif
+
+  if (ratio == 1) {
+    for (; count > 0; count--) {
+      mixDelta(result++, MIX_DELTA(*samples++, gain));
+    }
+  }
+  else {
+    for (; count > 0; count--) {
+      int delta = MIX_DELTA(*samples++, gain);
+      for (unsigned int j=0; j<ratio; j++) {
+        mixDelta(result++, delta);
+      }
+    }
+  }
+}
+
+void mixTone(audio_data_t * result, unsigned int count, uint32_t & phase, uint32_t step, int gain)
 {
-  *result = limit(AUDIO_DATA_MIN, *result + ((sample >> fade) >> (16-AUDIO_BITS_PER_SAMPLE)), AUDIO_DATA_MAX);
+  uint32_t idx = phase;
+
+#if defined(MIX_SADD16)
+  if (((uintptr_t)result & 3) == 0) {
+    uint32_t * words = (uint32_t *)result;
+    for (; count >= 2; count -= 2) {
+      int delta = MIX_DELTA(sineValues[idx >> 16], gain);
+      idx = (idx + step) & (SINE_PHASE_PERIOD - 1);
+      *words = MIX_SADD16(*words, MIX_PAIR(delta, MIX_DELTA(sineValues[idx >> 16], gain)));
+      words++;
+      idx = (idx + step) & (SINE_PHASE_PERIOD - 1);
+    }
+    result = (audio_data_t *)words;
+  }
+#endif
+
+  for (; count > 0; count--) {
+    mixDelta(result++, MIX_DELTA(sineValues[idx >> 16], gain));
+    idx = (idx + step) & (SINE_PHASE_PERIOD - 1);
+  }
+
+  phase = idx;
 }
 
 #if defined(SDCARD)
@@ -542,114 +638,170 @@ inline void mixSample(audio_data_t * result, int sample, unsigned int fade)
 #define RIFF_CHUNK_SIZE 12
 uint8_t wavBuffer[AUDIO_BUFFER_SIZE*2] __DMA;
 
-int WavContext::mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade)
+bool WavContext::open()
 {
-  FRESULT result = FR_OK;
   UINT read = 0;
-
-  if (fragment.file[1]) {
-    result = f_open(&state.file, fragment.file, FA_OPEN_EXISTING | FA_READ);
-    fragment.file[1] = 0;
-    if (result == FR_OK) {
-      result = f_read(&state.file, wavBuffer, RIFF_CHUNK_SIZE+8, &read);
-      if (result == FR_OK && read == RIFF_CHUNK_SIZE+8 && !memcmp(wavBuffer, "RIFF", 4) && !memcmp(wavBuffer+8, "WAVEfmt ", 8)) {
-        uint32_t size = *((uint32_t *)(wavBuffer+16));
-        result = (size < 256 ? f_read(&state.file, wavBuffer, size+8, &read) : FR_DENIED);
-        if (result == FR_OK && read == size+8) {
-          state.codec = ((uint16_t *)wavBuffer)[0];
-          state.freq = ((uint16_t *)wavBuffer)[2];
-          uint32_t *wavSamplesPtr = (uint32_t *)(wavBuffer + size);
-          uint32_t size = wavSamplesPtr[1];
-          if (state.freq != 0 && state.freq * (AUDIO_SAMPLE_RATE / state.freq) == AUDIO_SAMPLE_RATE) {
-            state.resampleRatio = (AUDIO_SAMPLE_RATE / state.freq);
-            state.readSize = (state.codec == CODEC_ID_PCM_S16LE ? 2*AUDIO_BUFFER_SIZE : AUDIO_BUFFER_SIZE) / state.resampleRatio;
-          }
-          else {
-            result = FR_DENIED;
-          }
-          while (result == FR_OK && memcmp(wavSamplesPtr, "data", 4) != 0) {
-            result = f_lseek(&state.file, f_tell(&state.file)+size);
-            if (result == FR_OK) {
-              result = f_read(&state.file, wavBuffer, 8, &read);
-              if (read != 8) result = FR_DENIED;
-              wavSamplesPtr = (uint32_t *)wavBuffer;
-              size = wavSamplesPtr[1];
-            }
-          }
-          state.size = size;
+  FRESULT result = f_open(&state.file, fragment.file, FA_OPEN_EXISTING | FA_READ);
+  state.status = WAV_ERROR;
+  if (result == FR_OK) {
+    result = f_read(&state.file, wavBuffer, RIFF_CHUNK_SIZE+8, &read);
+    if (result == FR_OK && read == RIFF_CHUNK_SIZE+8 && !memcmp(wavBuffer, "RIFF", 4) && !memcmp(wavBuffer+8, "WAVEfmt ", 8)) {
+      uint32_t size = *((uint32_t *)(wavBuffer+16));
+      result = (size < 256 ? f_read(&state.file, wavBuffer, size+8, &read) : FR_DENIED);
+      if (result == FR_OK && read == size+8) {
+        state.codec = ((uint16_t *)wavBuffer)[0];
+        state.freq = ((uint16_t *)wavBuffer)[2];
+        uint32_t *wavSamplesPtr = (uint32_t *)(wavBuffer + size);
+        uint32_t size = wavSamplesPtr[1];
+        if (state.freq != 0 && state.freq * (AUDIO_SAMPLE_RATE / state.freq) == AUDIO_SAMPLE_RATE) {
+          state.resampleRatio = (AUDIO_SAMPLE_RATE / state.freq);
         }
         else {
           result = FR_DENIED;
         }
-      }
-      else {
-        result = FR_DENIED;
+        if (state.codec == CODEC_ID_PCM_S16LE)
+          state.bytesPerSample = 2;
+        else if (state.codec == CODEC_ID_PCM_ALAW || state.codec == CODEC_ID_PCM_MULAW)
+          state.bytesPerSample = 1;
+        else
+          result = FR_DENIED;
+        while (result == FR_OK && memcmp(wavSamplesPtr, "data", 4) != 0) {
+          result = f_lseek(&state.file, f_tell(&state.file)+size);
+          if (result == FR_OK) {
+            result = f_read(&state.file, wavBuffer, 8, &read);
+            if (read != 8) result = FR_DENIED;
+            wavSamplesPtr = (uint32_t *)wavBuffer;
+            size = wavSamplesPtr[1];
+          }
+        }
+        if (result == FR_OK) {
+          state.size = size;
+          state.ringIdx = 0;
+          state.ringCount = 0;
+          state.status = WAV_OPENED;
+          return true;
+        }
       }
     }
+    f_close(&state.file);
   }
+  return false;
+}
 
-  if (result == FR_OK) {
-    read = 0;
-    result = f_read(&state.file, wavBuffer, state.readSize, &read);
-    if (result == FR_OK) {
-      if (read > state.size) {
-        read = state.size;
-      }
+// reads and decodes samples until the ring is full or the file ends
+bool WavContext::fill()
+{
+  while (state.size > 0 && state.ringCount < AUDIO_WAV_RING_SIZE) {
+    UINT read = 0;
+    UINT count = min<UINT>((AUDIO_WAV_RING_SIZE - state.ringCount) * state.bytesPerSample, sizeof(wavBuffer));
+    if (count > state.size) {
+      count = state.size;
+    }
+    if (f_read(&state.file, wavBuffer, count, &read) != FR_OK) {
+      f_close(&state.file);
+      state.size = 0;
+      return false;
+    }
+    if (read == count) {
       state.size -= read;
+    }
+    else {
+      state.size = 0;
+    }
+    if (state.size == 0) {
+      f_close(&state.file);
+    }
 
-      if (read != state.readSize) {
-        f_close(&state.file);
-        fragment.clear();
+    unsigned int idx = state.ringIdx + state.ringCount;
+    read /= state.bytesPerSample;
+    for (uint32_t i=0; i<read; i++) {
+      if (idx >= AUDIO_WAV_RING_SIZE) {
+        idx -= AUDIO_WAV_RING_SIZE;
       }
+      if (state.codec == CODEC_ID_PCM_S16LE)
+        ring[idx++] = ((int16_t *)wavBuffer)[i];
+      else if (state.codec == CODEC_ID_PCM_ALAW)
+        ring[idx++] = alawTable[wavBuffer[i]];
+      else
+        ring[idx++] = ulawTable[wavBuffer[i]];
+    }
+    state.ringCount += read;
+  }
+  return true;
+}
 
-      audio_data_t * samples = buffer->data;
-      if (state.codec == CODEC_ID_PCM_S16LE) {
-        read /= 2;
-        for (uint32_t i=0; i<read; i++) {
-          for (uint8_t j=0; j<state.resampleRatio; j++) {
-            mixSample(samples++, ((int16_t *)wavBuffer)[i], fade+2-volume);
-          }
-        }
-      }
-      else if (state.codec == CODEC_ID_PCM_ALAW) {
-        for (uint32_t i=0; i<read; i++) {
-          for (uint8_t j=0; j<state.resampleRatio; j++) {
-            mixSample(samples++, alawTable[wavBuffer[i]], fade+2-volume);
-          }
-        }
-      }
-      else if (state.codec == CODEC_ID_PCM_MULAW) {
-        for (uint32_t i=0; i<read; i++) {
-          for (uint8_t j=0; j<state.resampleRatio; j++) {
-            mixSample(samples++, ulawTable[wavBuffer[i]], fade+2-volume);
-          }
-        }
+void WavContext::prefetch()
+{
+  if (fragment.type == FRAGMENT_FILE) {
+    if (state.status == WAV_CLOSED) {
+      open();
+    }
+    if (state.status == WAV_OPENED && !fill()) {
+      state.status = WAV_ERROR;
+    }
+  }
+}
+
+int WavContext::mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade, unsigned int offset)
+{
+  if (state.status == WAV_CLOSED) {
+    open();
+  }
+
+  if (state.status == WAV_OPENED) {
+    if (state.ringCount * state.resampleRatio < AUDIO_BUFFER_SIZE - offset && state.size > 0) {
+      audioStats.syncReads++;
+      if (!fill()) {
+        state.status = WAV_ERROR;
       }
+    }
+  }
 
-      return samples - buffer->data;
+  if (state.status != WAV_OPENED) {
+    clear();
+    return 0;
+  }
+
+  audio_data_t * samples = &buffer->data[offset];
+  unsigned int count = min<unsigned int>(state.ringCount, (AUDIO_BUFFER_SIZE - offset) / state.resampleRatio);
+  int gain = mixGain(AUDIO_GAIN_UNITY >> (fade+2-volume));
+  while (count > 0) {
+    unsigned int block = min<unsigned int>(count, AUDIO_WAV_RING_SIZE - state.ringIdx);
+    mixSamples(samples, &ring[state.ringIdx], block, state.resampleRatio, gain);
+    samples += block * state.resampleRatio;
+    state.ringIdx += block;
+    if (state.ringIdx >= AUDIO_WAV_RING_SIZE) {
+      state.ringIdx = 0;
     }
+    state.ringCount -= block;
+    count -= block;
   }
 
-  if (result != FR_OK) {
+  if (state.ringCount == 0 && state.size == 0) {
     clear();
   }
-  return 0;
+
+  return samples - buffer->data;
 }
 #else
-int WavContext::mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade)
+int WavContext::mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade, unsigned int offset)
 {
   return 0;
 }
+
+void WavContext::prefetch()
+{
+}
 #endif
 
 const unsigned int toneVolumes[] = { 10, 8, 6, 4, 2 };
-inline float evalVolumeRatio(int freq, int volume)
+inline int evalToneGain(int freq, int volume)
 {
-  float result = toneVolumes[2+volume];
+  int result = AUDIO_GAIN_UNITY / toneVolumes[2+volume];
   if (freq < 330) {
-    result = (result * freq * freq) / (330 * 330);
+    result = (result * 330 * 330) / (freq * freq);
   }
-  return result;
+  return min(result, 2*AUDIO_GAIN_UNITY); // the sine samples stay in 16 bits
 }
 
 int ToneContext::mixBuffer(AudioBuffer * buffer, int volume, unsigned int fade)
@@ -660,7 +812,6 @@ int ToneContext::mixBuffer(AudioBuffer * buffer, int volume, unsigned int fade)
   int remainingDuration = fragment.tone.duration - state.duration;
   if (remainingDuration > 0) {
     int points;
-    float toneIdx = state.idx;
 
     if (fragment.tone.reset) {
       fragment.tone.reset = 0;
@@ -670,8 +821,8 @@ int ToneContext::mixBuffer(AudioBuffer * buffer, int volume, unsigned int fade)
 
     if (fragment.tone.freq != state.freq) {
       state.freq = fragment.tone.freq;
-      state.step = limit<float>(1, float(fragment.tone.freq) * (float(DIM(sineValues))/float(AUDIO_SAMPLE_RATE)), 512);
-      state.volume = 1.0f / evalVolumeRatio(fragment.tone.freq, volume);
+      state.step = limit<uint32_t>(1 << 16, (uint64_t(fragment.tone.freq) * DIM(sineValues) << 16) / AUDIO_SAMPLE_RATE, 512 << 16);
+      state.volume = evalToneGain(fragment.tone.freq, volume);
     }
 
     if (fragment.tone.freqIncr) {
@@ -699,25 +850,19 @@ int ToneContext::mixBuffer(AudioBuffer * buffer, int volume, unsigned int fade)
     else {
       duration = remainingDuration;
       points = (duration * AUDIO_BUFFER_SIZE) / AUDIO_BUFFER_DURATION;
-      unsigned int end = toneIdx + (state.step * points);
-      if (end > DIM(sineValues))
-        end -= (end % DIM(sineValues));
+      // the tone ends at the end of a sine period
+      uint64_t end = state.idx + uint64_t(state.step) * points;
+      if (end > SINE_PHASE_PERIOD)
+        end -= (end % SINE_PHASE_PERIOD);
       else
-        end = DIM(sineValues);
-      points = (float(end) - toneIdx) / state.step;
+        end = SINE_PHASE_PERIOD;
+      points = (end - state.idx) / state.step;
     }
 
-    for (int i=0; i<points; i++) {
-      int16_t sample = sineValues[int(toneIdx)] * state.volume;
-      mixSample(&buffer->data[i], sample, fade);
-      toneIdx += state.step;
-      if ((unsigned int)toneIdx >= DIM(sineValues))
-        toneIdx -= DIM(sineValues);
-    }
+    mixTone(buffer->data, points, state.idx, state.step, mixGain(state.volume >> fade));
 
     if (remainingDuration > AUDIO_BUFFER_DURATION) {
       state.duration += AUDIO_BUFFER_DURATION;
-      state.idx = toneIdx;
       return AUDIO_BUFFER_SIZE;
     }
     else {
@@ -737,12 +882,62 @@ int ToneContext::mixBuffer(AudioBuffer * buffer, int volume, unsigned int fade)
   return result;
 }
 
+bool AudioQueue::isFileNext()
+{
+  CoEnterMutexSection(audioMutex);
+  const AudioFragment * fragment = fragmentsFifo.peek();
+  bool result = (fragment && fragment->type == FRAGMENT_FILE);
+  CoLeaveMutexSection(audioMutex);
+  return result;
+}
+
+void AudioQueue::startNextFragment()
+{
+  CoEnterMutexSection(audioMutex);
+  const AudioFragment * fragment = fragmentsFifo.get();
+  if (fragment && prefetchContext.isFragment(*fragment)) {
+    normalContext.setFragment(prefetchContext);
+    prefetchContext.clear();
+    audioStats.prefetchHits++;
+  }
+  else {
+    normalContext.setFragment(fragment);
+  }
+  CoLeaveMutexSection(audioMutex);
+}
+
+void AudioQueue::prefetch()
+{
+  // keep decoded samples ahead of the mixer
+  normalContext.prefetch();
+  if (isFunctionActive(FUNCTION_BACKGND_MUSIC)) {
+    backgroundContext.prefetch();
+  }
+
+  // open the next queued file and decode its first samples while the current fragment plays
+  AudioFragment next;
+  CoEnterMutexSection(audioMutex);
+  const AudioFragment * fragment = fragmentsFifo.peek();
+  if (fragment && fragment->type == FRAGMENT_FILE && !prefetchContext.isFragment(*fragment)) {
+    next = *fragment;
+  }
+  CoLeaveMutexSection(audioMutex);
+  if (next.type == FRAGMENT_FILE) {
+    prefetchContext.setFragment(next);
+    prefetchContext.prefetch();
+  }
+}
+
 void AudioQueue::wakeup()
 {
   DEBUG_TIMER_START(debugTimerAudioConsume);
   audioConsumeCurrentBuffer();
   DEBUG_TIMER_STOP(debugTimerAudioConsume);
 
+  if (playing && !buffersFifo.filledAtleast(1)) {
+    audioStats.underruns++;
+  }
+
   AudioBuffer * buffer;
   while ((buffer = buffersFifo.getEmptyBuffer()) != 0) {
     int result;
@@ -763,11 +958,16 @@ void AudioQueue::wakeup()
 
     // mix the normal context (tones and wavs)
     if (normalContext.isEmpty() && !fragmentsFifo.empty()) {
-      CoEnterMutexSection(audioMutex);
-      normalContext.setFragment(fragmentsFifo.get());
-      CoLeaveMutexSection(audioMutex);
+      startNextFragment();
     }
     result = normalContext.mixBuffer(buffer, g_eeGeneral.beepVolume, g_eeGeneral.wavVolume, fade);
+    // stacked files (numbers, units) follow each other in the same buffer
+    while (result > 0 && result < AUDIO_BUFFER_SIZE && normalContext.isEmpty() && isFileNext()) {
+      startNextFragment();
+      int next = normalContext.mixBuffer(buffer, g_eeGeneral.beepVolume, g_eeGeneral.wavVolume, fade, result);
+      if (next <= result) break;
+      result = next;
+    }
     if (result > 0) {
       size = max(size, result);
       fade += 1;
@@ -792,22 +992,20 @@ void AudioQueue::wakeup()
     if (size > 0) {
       // TRACE("pushing buffer %p", buffer);
       buffer->size = size;
-#if defined(SOFTWARE_VOLUME)
-      for(uint32_t i=0; i<buffer->size; ++i) {
-        int32_t tmpSample = (int32_t) ((uint32_t) (buffer->data[i]) - AUDIO_DATA_SILENCE);  // conversion from uint16_t
-        buffer->data[i] = (int16_t) (((tmpSample * currentSpeakerVolume) / VOLUME_LEVEL_MAX) + AUDIO_DATA_SILENCE);
-      }
-#endif
       buffersFifo.audioPushBuffer();
+      playing = true;
     }
     else {
       // break the endless loop
+      playing = false;
       break;
     }
     DEBUG_TIMER_START(debugTimerAudioConsume);
     audioConsumeCurrentBuffer();
     DEBUG_TIMER_STOP(debugTimerAudioConsume);
   }
+
+  prefetch();
 }
 
 inline unsigned int getToneLength(uint16_t len)
@@ -875,7 +1073,7 @@ void AudioQueue::playFile(const char * filename, uint8_t flags, uint8_t id)
     TRACE("file name too long! maximum length is %d characters", AUDIO_FILENAME_MAXLEN);
     return;
   }
-  #if !defined(SIMU_AUDIO)
+  #if !defined(SIMU_AUDIO) && !defined(GTESTS)
   return;
   #endif
 #endif
@@ -946,6 +1144,7 @@ void AudioQueue::flush()
   fragmentsFifo.clear();
   varioContext.clear();
   backgroundContext.clear();
+  prefetchContext.clear();
   CoLeaveMutexSection(audioMutex);
 }
 
@@ -80,6 +80,13 @@ template <unsigned int NUM_BITS> class BitField {
   #define AUDIO_BUFFER_COUNT           (3)
 #endif
 
+// decoded samples kept ahead of the mixer, in each WAV context (3 of them)
+#if defined(PCBSKY9X)
+  #define AUDIO_WAV_RING_SIZE          (AUDIO_BUFFER_SIZE)   // one buffer only, the RAM is short
+#else
+  #define AUDIO_WAV_RING_SIZE          (2*AUDIO_BUFFER_SIZE)
+#endif
+
 #define BEEP_MIN_FREQ                  (150)
 #define BEEP_MAX_FREQ                  (15000)
 #define BEEP_DEFAULT_FREQ              (2250)
@@ -125,6 +132,13 @@ struct AudioBuffer {
 
 extern AudioBuffer audioBuffers[AUDIO_BUFFER_COUNT];
 
+// Block mixing kernels: samples are scaled by a fixed point gain and added to the buffer with saturation.
+// The scaled samples must fit in 16 bits: up to AUDIO_GAIN_UNITY for files, 2*AUDIO_GAIN_UNITY for the sine.
+#define AUDIO_GAIN_SHIFT               (12)
+#define AUDIO_GAIN_UNITY               (1 << AUDIO_GAIN_SHIFT)
+void mixSamples(audio_data_t * result, const int16_t * samples, unsigned int count, unsigned int ratio, int gain);
+void mixTone(audio_data_t * result, unsigned int count, uint32_t & phase, uint32_t step, int gain);
+
 enum FragmentTypes {
   FRAGMENT_EMPTY,
   FRAGMENT_TONE,
@@ -192,9 +206,9 @@ class ToneContext {
     AudioFragment fragment;
 
     struct {
-      float step;
-      float idx;
-      float  volume;
+      uint32_t step;            // 16.16 fixed point steps in the sine table
+      uint32_t idx;
+      int32_t  volume;
       uint16_t freq;
       uint16_t duration;
       uint16_t pause;
@@ -202,17 +216,35 @@ class ToneContext {
 
 };
 
+enum WavStatus {
+  WAV_CLOSED,
+  WAV_OPENED,
+  WAV_ERROR,
+};
+
 class WavContext {
   public:
 
     inline void clear() { fragment.clear(); };
 
-    int mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade);
+    int mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade, unsigned int offset=0);
+    void prefetch();
     bool hasPromptId(uint8_t id) const { return fragment.id == id; };
 
+    bool isFragment(const AudioFragment & other) const
+    {
+      return fragment.type == FRAGMENT_FILE && fragment.id == other.id && !strcmp(fragment.file, other.file);
+    }
+
     void setFragment(const char * filename, uint8_t repeat, uint8_t id)
     {
-      fragment = AudioFragment(filename, repeat, id);
+      setFragment(AudioFragment(filename, repeat, id));
+    }
+
+    void setFragment(const AudioFragment & other)
+    {
+      fragment = other;
+      state.status = WAV_CLOSED;
     }
 
     void stop(uint8_t id)
@@ -227,12 +259,20 @@ class WavContext {
 
     struct {
       FIL      file;
+      uint8_t  status;
       uint8_t  codec;
       uint32_t freq;
-      uint32_t size;
+      uint32_t size;            // bytes of samples not read yet
       uint8_t  resampleRatio;
-      uint16_t readSize;
+      uint8_t  bytesPerSample;
+      uint16_t ringIdx;
+      uint16_t ringCount;
     } state;
+
+    int16_t ring[AUDIO_WAV_RING_SIZE];
+
+    bool open();
+    bool fill();
 };
 
 class MixedContext {
@@ -249,10 +289,19 @@ class MixedContext {
     void setFragment(const AudioFragment * frag)
     {
       if (frag) {
-        fragment = *frag;
+        if (frag->type == FRAGMENT_FILE)
+          wav.setFragment(*frag);
+        else
+          fragment = *frag;
       }
     }
 
+    // takes over a file opened in advance
+    void setFragment(const WavContext & context)
+    {
+      wav = context;
+    }
+
     inline void clear()
     {
       tone.clear();   // the biggest member of the uninon
@@ -263,13 +312,18 @@ class MixedContext {
     bool isFile() const { return fragment.type == FRAGMENT_FILE; };
     bool hasPromptId(uint8_t id) const { return fragment.id == id; };
 
-    int mixBuffer(AudioBuffer *buffer, int toneVolume, int wavVolume, unsigned int fade)
+    int mixBuffer(AudioBuffer *buffer, int toneVolume, int wavVolume, unsigned int fade, unsigned int offset=0)
     {
       if (isTone()) return tone.mixBuffer(buffer, toneVolume, fade);
-      else if (isFile()) return wav.mixBuffer(buffer, wavVolume, fade);
+      else if (isFile()) return wav.mixBuffer(buffer, wavVolume, fade, offset);
       return 0;
     }
 
+    void prefetch()
+    {
+      if (isFile()) wav.prefetch();
+    }
+
   private:
     union {
       AudioFragment fragment;   // a hack: fragment is used to access the fragment members of tone and wav
@@ -450,6 +504,11 @@ class AudioFragmentFifo
       widx = ridx;                      // clean the queue
     }
 
+    const AudioFragment * peek() const
+    {
+      return empty() ? 0 : &fragments[ridx];
+    }
+
     const AudioFragment * get()
     {
       if (!empty()) {
@@ -501,13 +560,26 @@ class AudioQueue {
 
   private:
     volatile bool _started;
+    bool playing;
     MixedContext normalContext;
     WavContext   backgroundContext;
     ToneContext  priorityContext;
     ToneContext  varioContext;
+    WavContext   prefetchContext;   // the next queued file, opened while the current fragment plays
     AudioFragmentFifo fragmentsFifo;
+
+    bool isFileNext();
+    void startNextFragment();
+    void prefetch();
+};
+
+struct AudioStats {
+  uint16_t underruns;           // no buffer was left to play while a fragment was playing
+  uint16_t syncReads;           // the mixer had to wait for the SD card
+  uint16_t prefetchHits;        // files started from the prefetch context
 };
 
+extern AudioStats audioStats;
 extern uint8_t currentSpeakerVolume;
 extern AudioQueue audioQueue;
 
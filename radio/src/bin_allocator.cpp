@@ -26,6 +26,7 @@
 
 BinAllocator_slots1 slots1;
 BinAllocator_slots2 slots2;
+uint32_t binHeapFallbacks = 0;
 
 #if defined(DEBUG)
 int SimulateMallocFailure = 0;    //set this to simulate allocation failure
@@ -72,6 +73,7 @@ void * bin_realloc(void * ptr, size_t size)
     if (res == 0) {
       // we don't have the space, use libc malloc
       // TRACE("bin_malloc [%lu] FAILURE", size);
+      ++binHeapFallbacks;
       res = malloc(size);
       if (res == 0) {
         TRACE("libc malloc [%lu] FAILURE", size);  
@@ -119,6 +121,9 @@ void *bin_l_alloc (void *ud, void *ptr, size_t osize, size_t nsize)
       // TRACE("OUR realloc %p[%lu] -> %p[%lu]", ptr, osize, res, nsize); 
     }
     if (res == 0) {
+      if (ptr == 0) {
+        ++binHeapFallbacks;
+      }
       res = realloc(ptr, nsize);
       // TRACE("libc realloc %p[%lu] -> %p[%lu]", ptr, osize, res, nsize);
       // if (res == 0 ){
@@ -23,6 +23,8 @@
 
 #include "debug.h"
 
+// Fixed size bins, the free ones are chained through their data, which
+// makes malloc() and free() constant time
 template <int SIZE_SLOT, int NUM_BINS> class BinAllocator {
 private:
   PACK(struct Bin {
@@ -31,43 +33,62 @@ private:
   });
   struct Bin Bins[NUM_BINS];
   int NoUsedBins;
+  int PeakUsedBins;
+  int FirstFreeBin;
+  int nextFreeBin(int n) {
+    int next;
+    memcpy(&next, Bins[n].data, sizeof(next));
+    return next;
+  }
+  void setNextFreeBin(int n, int next) {
+    memcpy(Bins[n].data, &next, sizeof(next));
+  }
+  int index(void * ptr) {
+    return ((char *)ptr - Bins[0].data) / (int)sizeof(Bin);
+  }
 public:
-  BinAllocator() : NoUsedBins(0) {
+  BinAllocator() : NoUsedBins(0), PeakUsedBins(0), FirstFreeBin(0) {
+    static_assert(SIZE_SLOT >= sizeof(int), "SIZE_SLOT too small for the free list");
     memclear(Bins, sizeof(Bins));
+    for (int n = 0; n < NUM_BINS; ++n) {
+      setNextFreeBin(n, n + 1 < NUM_BINS ? n + 1 : -1);
+    }
   }
   bool free(void * ptr) {
-    for (size_t n = 0; n < NUM_BINS; ++n) {
-      if (ptr == Bins[n].data) {
-        Bins[n].Used = false;
-        --NoUsedBins;
-        // TRACE("\tBinAllocator<%d> free %lu ------", SIZE_SLOT, n);
-        return true;
-      }
+    if (!is_member(ptr)) {
+      return false;
+    }
+    int n = index(ptr);
+    if (Bins[n].Used) {
+      Bins[n].Used = false;
+      setNextFreeBin(n, FirstFreeBin);
+      FirstFreeBin = n;
+      --NoUsedBins;
+      // TRACE("\tBinAllocator<%d> free %d ------", SIZE_SLOT, n);
     }
-    return false;
+    return true;
   }
   bool is_member(void * ptr) {
-    return (ptr >= Bins[0].data && ptr <= Bins[NUM_BINS-1].data);
+    // only the start of a bin can be handed back to us
+    return (ptr >= Bins[0].data && ptr <= Bins[NUM_BINS-1].data && ((char *)ptr - Bins[0].data) % sizeof(Bin) == 0);
   }
   void * malloc(size_t size) {
     if (size > SIZE_SLOT) {
       // TRACE("BinAllocator<%d> malloc [%lu] size > SIZE_SLOT", SIZE_SLOT, size);
       return 0;
     }
-    if (NoUsedBins >= NUM_BINS) {
+    if (FirstFreeBin < 0) {
       // TRACE("BinAllocator<%d> malloc [%lu] no free slots", SIZE_SLOT, size);
       return 0;
     }
-    for (size_t n = 0; n < NUM_BINS; ++n) {
-      if (!Bins[n].Used) {
-        Bins[n].Used = true;
-        ++NoUsedBins;
-        // TRACE("\tBinAllocator<%d> malloc %lu[%lu]", SIZE_SLOT, n, size);
-        return Bins[n].data;
-      }
+    int n = FirstFreeBin;
+    FirstFreeBin = nextFreeBin(n);
+    Bins[n].Used = true;
+    if (++NoUsedBins > PeakUsedBins) {
+      PeakUsedBins = NoUsedBins;
     }
-    // TRACE("BinAllocator<%d> malloc [%lu] no free slots", SIZE_SLOT , size);
-    return 0;
+    // TRACE("\tBinAllocator<%d> malloc %d[%lu]", SIZE_SLOT, n, size);
+    return Bins[n].data;
   }
   size_t size(void * ptr) {
     return is_member(ptr) ? SIZE_SLOT : 0;
@@ -77,6 +98,7 @@ public:
   }
   unsigned int capacity() { return NUM_BINS; }
   unsigned int size() { return NoUsedBins; }
+  unsigned int peak() { return PeakUsedBins; }
 };
 
 #if defined(SIMU)
@@ -91,6 +113,9 @@ typedef BinAllocator<91,50> BinAllocator_slots2;
 extern BinAllocator_slots1 slots1;
 extern BinAllocator_slots2 slots2;
 
+// allocations which didn't fit in our bins and went to the libc heap
+extern uint32_t binHeapFallbacks;
+
 // wrapper for our BinAllocator for Lua
 void *bin_l_alloc (void *ud, void *ptr, size_t osize, size_t nsize);
 #endif   //#if defined(USE_BIN_ALLOCATOR)
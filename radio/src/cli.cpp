@@ -20,6 +20,7 @@
 
 #include "opentx.h"
 #include "diskio.h"
+#include "bin_allocator.h"
 #include <ctype.h>
 #include <malloc.h>
 #include <new>
@@ -727,6 +728,11 @@ int cliMemoryInfo(const char ** argv)
   serialPrint("------------");
   serialPrint("\tTotal   %u", s + w + e);
 #endif
+#if defined(USE_BIN_ALLOCATOR)
+  serialPrint("\tBins1   %u/%u (peak %u)", slots1.size(), slots1.capacity(), slots1.peak());
+  serialPrint("\tBins2   %u/%u (peak %u)", slots2.size(), slots2.capacity(), slots2.peak());
+  serialPrint("\tHeap fallbacks %u", binHeapFallbacks);
+#endif
 #endif
   return 0;
 }
@@ -890,6 +896,32 @@ void printDebugTimers()
 }
 #endif
 
+void printProfilerHistogram(const char * name, const ProfilerHistogram & histogram)
+{
+  serialPrint("%s: n: %u, p50: %uus, p99: %uus", name, histogram.getCount(), histogram.getPercentile(50), histogram.getPercentile(99));
+  for (int i=0; i<PROFILER_HISTOGRAM_BUCKETS; i++) {
+    if (histogram.buckets[i]) {
+      serialPrint("  <%6uus: %u", ProfilerHistogram::getBucketLimit(i), histogram.buckets[i]);
+    }
+  }
+}
+
+void printProfiler()
+{
+  serialPrint("CPU load:");
+  for (int i=0; i<PROFILER_TASKS_COUNT; i++) {
+    uint32_t load = profiler.getTaskLoad(i);
+    serialPrint("  %-11s %u.%u%%", profilerTaskNames[i], load/10, load%10);
+  }
+  serialPrint("Mixer stages (%u runs):", profiler.mixerRuns);
+  for (int i=PROFILER_STAGE_NONE+1; i<PROFILER_STAGES_COUNT; i++) {
+    serialPrint("  %-11s %uus", profilerStageNames[i], profiler.getStageAverage(i));
+  }
+  printProfilerHistogram("Mixer duration", profiler.mixerDuration);
+  printProfilerHistogram("Mixer to pulses", profiler.mixerToPulses);
+  serialPrint("Mixer scheduler: estimate: %uus, frames: %u, stale: %u", mixerDurationEstimate, mixerSchedulerStats.frames, mixerSchedulerStats.staleFrames);
+}
+
 #include "OsMutex.h"
 extern OS_MutexID audioMutex;
 
@@ -913,6 +945,7 @@ void printAudioVars()
   serialPrint("audioQueue:  readIdx: %d, writeIdx: %d, full: %d", audioQueue.buffersFifo.readIdx, audioQueue.buffersFifo.writeIdx, audioQueue.buffersFifo.bufferFull);
 
   serialPrint("normalContext: %u", (uint32_t)audioQueue.normalContext.fragment.type);
+  serialPrint("underruns: %u, sync reads: %u, prefetched: %u", audioStats.underruns, audioStats.syncReads, audioStats.prefetchHits);
 
   serialPrint("audioMutex[%u] = %u", (uint32_t)audioMutex, (uint32_t)MutexTbl[audioMutex].mutexFlag);
 }
@@ -1044,8 +1077,31 @@ int cliDisplay(const char ** argv)
     DiskCacheStats stats = diskCache.getStats();
     uint32_t hitRate = diskCache.getHitRate();
     serialPrint("Disk Cache stats: w:%u r: %u, h: %u(%0.1f%%), m: %u", stats.noWrites, (stats.noHits + stats.noMisses), stats.noHits, hitRate*0.1f, stats.noMisses);
+    serialPrint("  read-ahead: %u, h: %u", stats.noReadAheads, stats.noReadAheadHits);
+    static const char * const DISK_CACHE_CLIENTS[] = { "other", "audio", "lua", "bitmaps" };
+    for (int i=0; i<DISK_CACHE_CLIENTS_COUNT; i++) {
+      serialPrint("  %s: h: %u(%0.1f%%), m: %u", DISK_CACHE_CLIENTS[i], stats.clients[i].noHits, diskCache.getHitRate(i)*0.1f, stats.clients[i].noMisses);
+    }
   }
 #endif
+  else if (!strcmp(argv[1], "prof")) {
+    printProfiler();
+    if (argv[2] && !strcmp(argv[2], "reset")) {
+      profiler.reset();
+      memclear(&mixerSchedulerStats, sizeof(mixerSchedulerStats));
+    }
+  }
+#if !defined(EEPROM)
+  else if (!strcmp(argv[1], "storage")) {
+    serialPrint("Storage writes: %u, coalesced: %u, bytes: %u, errors: %u, max: %ums", storageStats.writes, storageStats.coalesced, storageStats.bytes, storageStats.errors, 10*storageStats.maxDuration);
+#if !defined(SIMU)
+    serialPrint("Storage stack free: %u", storageStackAvailable());
+#endif
+  }
+#endif
+  else if (!strcmp(argv[1], "sensors")) {
+    serialPrint("Sensors index stats: h: %u, m: %u, s: %u, r: %u", telemetrySensorsIndexStats.hits, telemetrySensorsIndexStats.misses, telemetrySensorsIndexStats.stale, telemetrySensorsIndexStats.rebuilds);
+  }
   else if (toLongLongInt(argv, 1, &address) > 0) {
     int size = 256;
     if (toInt(argv, 2, &size) >= 0) {
@@ -1170,7 +1226,7 @@ const CliCommand cliCommands[] = {
   { "readsd", cliReadSD, "<start sector> <sectors count> <read buffer size (sectors)>" },
   { "testsd", cliTestSD, "" },
   { "play", cliPlay, "<filename>" },
-  { "print", cliDisplay, "<address> [<size>] | <what>" },
+  { "print", cliDisplay, "<address> [<size>] | <what> | prof [reset]" },
   { "p", cliDisplay, "<address> [<size>] | <what>" },
   { "reboot", cliReboot, "[wdt]" },
   { "set", cliSet, "<what> <value>" },
@@ -53,6 +53,7 @@ void loadCurves()
     curveEnd[i] = tmp;
 
   }
+  invalidateCurves();
   if (showWarning) {
     POPUP_WARNING("Invalid curve data repaired");
     const char * w = "check your curves, logic switches";
@@ -364,16 +365,121 @@ int applyCurve(int x, CurveRef & curve)
   return x;
 }
 
+// Smooth curves are compiled on their first use after the model has been
+// loaded or edited: the X positions of the points are converted once to RESX
+// units and the tangents are computed once, so that each evaluation is only a
+// binary search and the spline itself. The results are the same as
+// hermite_spline(), which is still used for curves with unordered X points
+// (only possible with corrupted data). intpol() is cheap enough as it is.
+
+struct CompiledCurve {
+  uint32_t version;  // curvesVersion when compiled
+  uint8_t count;     // 0 when the curve can't be compiled
+};
+
+CompiledCurve compiledCurves[MAX_CURVES];
+// indexed like g_model.points[], each curve uses at least one byte per point
+int16_t compiledCurvesX[MAX_CURVE_POINTS];
+int32_t compiledCurvesTangents[MAX_CURVE_POINTS];
+volatile uint32_t curvesVersion = 1;
+
+void invalidateCurves()
+{
+  curvesVersion++;
+}
+
+static void compileCurve(uint8_t idx)
+{
+  CurveInfo & crv = g_model.curves[idx];
+  CompiledCurve & compiled = compiledCurves[idx];
+  uint32_t version = curvesVersion;
+  int8_t * points = curveAddress(idx);
+  int offset = points - g_model.points;
+  uint8_t count = crv.points + 5;
+  int16_t * xs = &compiledCurvesX[offset];
+
+  compiled.count = 0;
+  if (offset < 0 || offset + count > MAX_CURVE_POINTS) {
+    compiled.version = version;
+    return;
+  }
+
+  for (int i=0; i<count; i++) {
+    if (i == 0)
+      xs[i] = -RESX;
+    else if (i == count-1)
+      xs[i] = RESX;
+    else if (crv.type == CURVE_TYPE_CUSTOM)
+      xs[i] = calc100toRESX(points[count+i-1]);
+    else
+      xs[i] = -RESX + (i*2*RESX)/(count-1);
+    if (i > 0 && xs[i] < xs[i-1]) {
+      compiled.version = version;
+      return;
+    }
+    compiledCurvesTangents[offset+i] = compute_tangent(&crv, points, i);
+  }
+
+  compiled.count = count;
+  compiled.version = version;
+}
+
+static int16_t compiled_hermite_spline(int16_t x, int8_t * points, uint8_t count)
+{
+  int offset = points - g_model.points;
+  const int16_t * xs = &compiledCurvesX[offset];
+
+  if (x < -RESX)
+    x = -RESX;
+  else if (x > RESX)
+    x = RESX;
+
+  // first segment ending at or after x, as hermite_spline() does
+  int i = 0, last = count - 2;
+  while (i < last) {
+    int mid = (i + last) / 2;
+    if (xs[mid+1] >= x)
+      last = mid;
+    else
+      i = mid + 1;
+  }
+
+  int32_t p0x = xs[i];
+  int32_t p0y = calc100toRESX(points[i]);
+  int32_t p3y = calc100toRESX(points[i+1]);
+  int32_t m0 = compiledCurvesTangents[offset+i];
+  int32_t m3 = compiledCurvesTangents[offset+i+1];
+  int32_t h = xs[i+1] - p0x;
+  int32_t t = (h > 0 ? (MMULT * (x - p0x)) / h : 0);
+  int32_t t2 = t * t / MMULT;
+  int32_t t3 = t2 * t / MMULT;
+  int32_t h00 = 2*t3 - 3*t2 + MMULT;
+  int32_t h10 = t3 - 2*t2 + t;
+  int32_t h01 = -2*t3 + 3*t2;
+  int32_t h11 = t3 - t2;
+  int32_t y = p0y * h00 + h * (m0 * h10 / MMULT) + p3y * h01 + h * (m3 * h11 / MMULT);
+  y /= MMULT;
+  return y;
+}
+
 int applyCustomCurve(int x, uint8_t idx)
 {
   if (idx >= MAX_CURVES)
     return 0;
 
   CurveInfo & crv = g_model.curves[idx];
-  if (crv.smooth)
-    return hermite_spline(x, idx);
-  else
+  if (!crv.smooth)
     return intpol(x, idx);
+
+  if (compiledCurves[idx].version != curvesVersion) {
+    compileCurve(idx);
+  }
+
+  uint8_t count = compiledCurves[idx].count;
+  if (count)
+    return compiled_hermite_spline(x, curveAddress(idx), count);
+  else
+    return hermite_spline(x, idx);
 }
 #else
 int applyCurve(int x, int8_t idx)
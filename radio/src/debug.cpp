@@ -267,3 +267,135 @@ const char * const debugTimerNames[DEBUG_TIMERS_COUNT] = {
 };
 
 #endif
+
+#if defined(CPUARM)
+Profiler profiler;
+
+const char * const profilerTaskNames[PROFILER_TASKS_COUNT] = {
+  "Mixer",
+  "Menus",
+  "Audio",
+  "Lua",
+};
+
+const char * const profilerStageNames[PROFILER_STAGES_COUNT] = {
+  "None",
+  "Inputs",
+  "Logical sw.",
+  "Mixes",
+  "Functions",
+  "Limits",
+  "Timers",
+  "Telemetry",
+};
+
+void ProfilerHistogram::add(uint32_t us)
+{
+  uint8_t bucket = 0;
+  while (us && bucket < PROFILER_HISTOGRAM_BUCKETS-1) {
+    us >>= 1;
+    bucket++;
+  }
+  buckets[bucket]++;
+}
+
+uint32_t ProfilerHistogram::getCount() const
+{
+  uint32_t count = 0;
+  for (uint8_t i=0; i<PROFILER_HISTOGRAM_BUCKETS; i++) {
+    count += buckets[i];
+  }
+  return count;
+}
+
+uint32_t ProfilerHistogram::getPercentile(uint8_t percent) const
+{
+  uint32_t count = getCount();
+  if (count == 0) {
+    return 0;
+  }
+  uint32_t threshold = (uint64_t(count) * percent + 99) / 100;
+  uint32_t total = 0;
+  for (uint8_t i=0; i<PROFILER_HISTOGRAM_BUCKETS; i++) {
+    total += buckets[i];
+    if (total >= threshold) {
+      return getBucketLimit(i);
+    }
+  }
+  return getBucketLimit(PROFILER_HISTOGRAM_BUCKETS-1);
+}
+
+void Profiler::reset()
+{
+  memclear(taskTime, sizeof(taskTime));
+  memclear(stageTime, sizeof(stageTime));
+  mixerRuns = 0;
+  memclear(&mixerDuration, sizeof(mixerDuration));
+  memclear(&mixerToPulses, sizeof(mixerToPulses));
+  resetTicks = CoGetOSTime();
+}
+
+void Profiler::start(ProfilerStamp & stamp)
+{
+  stamp.ticks = CoGetOSTime();
+  stamp.tmr2MHz = getTmr2MHz();
+}
+
+uint32_t Profiler::elapsed(const ProfilerStamp & stamp)
+{
+  uint32_t ticks = (uint32_t)CoGetOSTime() - stamp.ticks;
+  if (ticks >= 16) {
+    return ticks * 2000;
+  }
+  return (uint16_t)(getTmr2MHz() - stamp.tmr2MHz) / 2;
+}
+
+void Profiler::mixerStart()
+{
+  start(mixerStamp);
+  stage = PROFILER_STAGE_INPUTS;
+  stageStart = mixerStamp;
+}
+
+void Profiler::setStage(uint8_t value)
+{
+  if (stage != PROFILER_STAGE_NONE) {
+    stageTime[stage] += elapsed(stageStart);
+    stage = value;
+    start(stageStart);
+  }
+}
+
+void Profiler::mixerStop()
+{
+  setStage(PROFILER_STAGE_NONE);
+  uint32_t us = elapsed(mixerStamp);
+  taskTime[PROFILER_TASK_MIXER] += us;
+  mixerDuration.add(us);
+  mixerRuns++;
+}
+
+void Profiler::outputsReady()
+{
+  start(outputsStamp);
+  outputsValid = true;
+}
+
+void Profiler::outputsUsed()
+{
+  if (outputsValid) {
+    mixerToPulses.add(elapsed(outputsStamp));
+  }
+}
+
+uint32_t Profiler::getTaskLoad(uint8_t task)
+{
+  uint64_t total = uint64_t((uint32_t)CoGetOSTime() - resetTicks) * 2000;
+  return total ? taskTime[task] * 1000 / total : 0;
+}
+
+uint32_t Profiler::getStageAverage(uint8_t stage) const
+{
+  return mixerRuns ? stageTime[stage] / mixerRuns : 0;
+}
+#endif
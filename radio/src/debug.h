@@ -423,5 +423,124 @@ extern const char * const debugTimerNames[DEBUG_TIMERS_COUNT];
 
 #endif //#if defined(DEBUG_TIMERS)
 
+#if defined(CPUARM) && defined(__cplusplus)
+
+// The profiler is always available, unlike the debug timers above
+enum ProfilerTasks {
+  PROFILER_TASK_MIXER,
+  PROFILER_TASK_MENUS,
+  PROFILER_TASK_AUDIO,
+  PROFILER_TASK_LUA,      // runs inside the menus task
+  PROFILER_TASKS_COUNT
+};
+
+enum ProfilerStages {
+  PROFILER_STAGE_NONE,
+  PROFILER_STAGE_INPUTS,
+  PROFILER_STAGE_LOGICAL_SWITCHES,
+  PROFILER_STAGE_MIXES,
+  PROFILER_STAGE_FUNCTIONS,
+  PROFILER_STAGE_LIMITS,
+  PROFILER_STAGE_TIMERS,
+  PROFILER_STAGE_TELEMETRY,
+  PROFILER_STAGES_COUNT
+};
+
+#define PROFILER_HISTOGRAM_BUCKETS     16
+
+// bucket 0 counts the durations below 1us, bucket n the ones in [2^(n-1), 2^n[us, the last one is open
+class ProfilerHistogram
+{
+  public:
+    void add(uint32_t us);
+    uint32_t getCount() const;
+    // upper bound (in us) of the bucket containing the given percentile, 0 if empty
+    uint32_t getPercentile(uint8_t percent) const;
+    static uint32_t getBucketLimit(uint8_t bucket) { return (uint32_t)1 << bucket; }
+
+    uint32_t buckets[PROFILER_HISTOGRAM_BUCKETS];
+};
+
+struct ProfilerStamp
+{
+  uint32_t ticks;
+  uint16_t tmr2MHz;
+};
+
+class Profiler
+{
+  public:
+    void reset();
+
+    void start(ProfilerStamp & stamp);
+    // in us, the 2MHz timer wraps after 32ms, longer durations use the OS ticks
+    uint32_t elapsed(const ProfilerStamp & stamp);
+
+    void addTaskTime(uint8_t task, uint32_t us)
+    {
+      taskTime[task] += us;
+    }
+
+    // the stages are only accounted between mixerStart() and mixerStop()
+    void mixerStart();
+    void setStage(uint8_t stage);
+    void mixerStop();
+    // channel outputs computed by the mixer, then used by the pulses
+    void outputsReady();
+    void outputsUsed();
+
+    // CPU time used since the last reset, per mille
+    uint32_t getTaskLoad(uint8_t task);
+    // average duration of a stage, us per mixer run
+    uint32_t getStageAverage(uint8_t stage) const;
+
+    uint64_t taskTime[PROFILER_TASKS_COUNT];   // us
+    uint64_t stageTime[PROFILER_STAGES_COUNT];  // us
+    uint32_t mixerRuns;
+    ProfilerHistogram mixerDuration;
+    ProfilerHistogram mixerToPulses;
+
+  protected:
+    uint32_t resetTicks;
+    uint8_t stage;
+    ProfilerStamp mixerStamp;
+    ProfilerStamp stageStart;
+    ProfilerStamp outputsStamp;
+    bool outputsValid;
+};
+
+extern Profiler profiler;
+extern const char * const profilerTaskNames[PROFILER_TASKS_COUNT];
+extern const char * const profilerStageNames[PROFILER_STAGES_COUNT];
+
+// accounts the time until the end of the scope to a task, including
+// the time of higher priority tasks preempting it
+class ProfilerTaskScope
+{
+  public:
+    explicit ProfilerTaskScope(uint8_t task):
+      task(task)
+    {
+      profiler.start(stamp);
+    }
+
+    ~ProfilerTaskScope()
+    {
+      profiler.addTaskTime(task, profiler.elapsed(stamp));
+    }
+
+  protected:
+    uint8_t task;
+    ProfilerStamp stamp;
+};
+
+#define PROFILER_STAGE(stage)          profiler.setStage(stage)
+
+#else // #if defined(CPUARM) && defined(__cplusplus)
+
+#define PROFILER_STAGE(stage)
+
+#endif // #if defined(CPUARM) && defined(__cplusplus)
+
 #endif // _DEBUG_H_
 
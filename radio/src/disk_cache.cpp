@@ -22,8 +22,21 @@
 #include "opentx.h"
 
 #if defined(SIMU) && !defined(SIMU_DISKIO)
-  #define __disk_read(...)    (RES_OK)
+// no SD card image, each sector is filled with its number
+static DRESULT simuDiskRead(BYTE drv, BYTE * buff, DWORD sector, UINT count)
+{
+  for (UINT i=0; i<count*BLOCK_SIZE; i+=sizeof(DWORD)) {
+    *(DWORD *)&buff[i] = sector + i/BLOCK_SIZE;
+  }
+  return RES_OK;
+}
+  #undef __disk_read
+  #undef __disk_write
+  #define __disk_read         simuDiskRead
   #define __disk_write(...)   (RES_OK)
+  #define getDiskSectors()    (0xFFFFFFFF)
+#else
+  #define getDiskSectors()    sdGetNoSectors()
 #endif
 
 #if 0     // set to 1 to enable traces
@@ -35,6 +48,10 @@
 DiskCache diskCache;
 
 DiskCacheBlock::DiskCacheBlock():
+  lastUse(0),
+  pinned(false),
+  readAhead(false),
+  stream(false),
   startSector(0),
   endSector(0) 
 {
@@ -52,13 +69,17 @@ bool DiskCacheBlock::read(BYTE * buff, DWORD sector, UINT count)
 
 DRESULT DiskCacheBlock::fill(BYTE drv, BYTE * buff, DWORD sector, UINT count)
 {
+  // the block content is lost even if the read fails
+  free();
   DRESULT res = __disk_read(drv, data, sector, DISK_CACHE_BLOCK_SECTORS);
   if (res != RES_OK) {
     return res;
   }
   startSector = sector;
   endSector = sector + DISK_CACHE_BLOCK_SECTORS;
-  memcpy(buff, data, count * BLOCK_SIZE);
+  if (count > 0) {
+    memcpy(buff, data, count * BLOCK_SIZE);
+  }
   TRACE_DISK_CACHE("\tcache %p FILLED from read(%u, %u)", this, (uint32_t)sector, (uint32_t)count);
   return RES_OK;
 }
@@ -67,13 +88,16 @@ void DiskCacheBlock::free(DWORD sector, UINT count)
 {
   if (sector < endSector && (sector+count) > startSector) {
     TRACE_DISK_CACHE("\tINVALIDATING disk cache block %p (%u)", this, startSector);
-    endSector = 0;
+    free();
   }
 }
 
 void DiskCacheBlock::free()
 {
   endSector = 0;
+  pinned = false;
+  readAhead = false;
+  stream = false;
 }
 
 bool DiskCacheBlock::empty() const
@@ -82,32 +106,119 @@ bool DiskCacheBlock::empty() const
 }
 
 DiskCache::DiskCache():
-  lastBlock(0)
+  clock(0),
+  client(DISK_CACHE_CLIENT_OTHER)
 {
-  stats.noHits = 0;
-  stats.noMisses = 0;
-  stats.noWrites = 0;
+  memclear(&stats, sizeof(stats));
+  memclear(nextSequentialSector, sizeof(nextSequentialSector));
   blocks = new DiskCacheBlock[DISK_CACHE_BLOCKS_NUM];
+#if defined(SIMU)
+  traceFile = NULL;
+  const char * tracePath = getenv("DISK_CACHE_TRACE");
+  if (tracePath) {
+    startTrace(tracePath);
+  }
+#endif
 }
 
 void DiskCache::clear()
 {
-  lastBlock = 0;
-  stats.noHits = 0;
-  stats.noMisses = 0;
-  stats.noWrites = 0;
+  clock = 0;
+  memclear(&stats, sizeof(stats));
+  memclear(nextSequentialSector, sizeof(nextSequentialSector));
   for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
     blocks[n].free();
   }
 }
 
+// Least recently used block, pinned blocks are skipped
+DiskCacheBlock * DiskCache::getVictim()
+{
+  DiskCacheBlock * victim = NULL;
+  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
+    DiskCacheBlock * block = &blocks[n];
+    if (block->empty()) {
+      return block;
+    }
+    if (!block->pinned && (!victim || (clock - block->lastUse) > (clock - victim->lastUse))) {
+      victim = block;
+    }
+  }
+  return victim;
+}
+
+void DiskCache::pin(DiskCacheBlock * block)
+{
+  // when too many blocks are pinned, the least recently used one is released
+  DiskCacheBlock * oldest = NULL;
+  uint8_t count = 0;
+  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
+    if (blocks[n].pinned) {
+      ++count;
+      if (!oldest || (clock - blocks[n].lastUse) > (clock - oldest->lastUse)) {
+        oldest = &blocks[n];
+      }
+    }
+  }
+  if (count >= DISK_CACHE_PINNED_MAX) {
+    oldest->pinned = false;
+  }
+  block->pinned = true;
+}
+
+// Read-ahead is synchronous, it costs one block read (DISK_CACHE_BLOCK_SECTORS sectors)
+// to the caller. It is only issued when the stream has consumed the end of its block, the
+// next request would miss anyway, so the read is done one request earlier, never in addition
+// to a miss. Only the last block of a stream is read for nothing.
+void DiskCache::prefetch(BYTE drv, DWORD sector)
+{
+  if (sector+DISK_CACHE_BLOCK_SECTORS >= getDiskSectors()) {
+    return;
+  }
+
+  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
+    if (sector >= blocks[n].startSector && sector < blocks[n].endSector) {
+      blocks[n].stream = true;
+      return;
+    }
+  }
+
+  DiskCacheBlock * block = getVictim();
+  if (block->fill(drv, NULL, sector, 0) == RES_OK) {
+    TRACE_DISK_CACHE("\t\t read-ahead(%u)", (uint32_t)sector);
+    block->lastUse = clock;
+    block->readAhead = true;
+    block->stream = true;
+    ++stats.noReadAheads;
+  }
+}
+
 DRESULT DiskCache::read(BYTE drv, BYTE * buff, DWORD sector, UINT count)
 {
-  // TODO: check if not caching first sectors would improve anything
-  // if (sector < 1000) {
-  //   ++stats.noMisses;
-  //   return __disk_read(drv, buff, sector, count);  
-  // }
+  uint8_t client = this->client;
+#if !defined(SIMU)
+  if (CoGetCurTaskID() == audioTaskId) {
+    client = DISK_CACHE_CLIENT_AUDIO;
+  }
+#endif
+
+#if !defined(SIMU) || defined(SIMU_DISKIO)
+  // FatFs reads the FAT and directories sectors in its window
+  bool metadata = (buff == g_FATFS_Obj.win);
+#else
+  bool metadata = false;
+#endif
+
+  return read(drv, buff, sector, count, client, metadata);
+}
+
+DRESULT DiskCache::read(BYTE drv, BYTE * buff, DWORD sector, UINT count, uint8_t client, bool metadata)
+{
+#if defined(SIMU)
+  if (traceFile) {
+    fprintf(traceFile, "R %u %u %u %u\n", (uint32_t)sector, (uint32_t)count, client, metadata);
+  }
+#endif
 
   // if read is bigger than cache block, then read it directly without using cache
   if (count > DISK_CACHE_BLOCK_SECTORS) {
@@ -116,39 +227,66 @@ DRESULT DiskCache::read(BYTE drv, BYTE * buff, DWORD sector, UINT count)
   }
   
   // if block + cache block size is beyond the end of the disk, then read it directly without using cache
-  if (sector+DISK_CACHE_BLOCK_SECTORS >= sdGetNoSectors()) {
-    TRACE_DISK_CACHE("\t\t cache would be beyond end of disk %u (%u)", (uint32_t)sector, sdGetNoSectors());
+  if (sector+DISK_CACHE_BLOCK_SECTORS >= getDiskSectors()) {
+    TRACE_DISK_CACHE("\t\t cache would be beyond end of disk %u (%u)", (uint32_t)sector, getDiskSectors());
     return __disk_read(drv, buff, sector, count);
   }
 
+  DiskCacheClientStats & clientStats = stats.clients[client];
+  ++clock;
+
   for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
-    if (blocks[n].read(buff, sector, count)) {
+    DiskCacheBlock * block = &blocks[n];
+    if (block->read(buff, sector, count)) {
       ++stats.noHits;
+      ++clientStats.noHits;
+      block->lastUse = clock;
+      if (metadata && !block->pinned) {
+        pin(block);
+      }
+      if (block->readAhead) {
+        block->readAhead = false;
+        ++stats.noReadAheadHits;
+      }
+      if (block->stream && sector+count == block->endSector) {
+        // the next request of the stream would miss, read its block now, one block ahead at most
+        block->stream = false;
+        nextSequentialSector[client] = block->endSector;
+        prefetch(drv, block->endSector);
+      }
       return RES_OK;
     }
   }
 
   ++stats.noMisses;
+  ++clientStats.noMisses;
 
-  // find free block
-  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
-    if (blocks[n].empty()) {
-      TRACE_DISK_CACHE("\t\t using free block");
-      return blocks[n].fill(drv, buff, sector, count);
-    }
+  DiskCacheBlock * block = getVictim();
+  DRESULT res = block->fill(drv, buff, sector, count);
+  if (res != RES_OK) {
+    return res;
   }
-
-  // use next block (round robin)
-  // TODO: use better strategy to select which used block gets used here
-  if (++lastBlock >= DISK_CACHE_BLOCKS_NUM) {
-    lastBlock = 0;
+  block->lastUse = clock;
+  if (metadata) {
+    pin(block);
   }
-  
-  return blocks[lastBlock].fill(drv, buff, sector, count);
+
+  // a miss continuing the previous miss of the same client is a sequential stream (WAV playback, file copy)
+  DWORD & nextSector = nextSequentialSector[client];
+  bool sequential = (nextSector > 0 && sector <= nextSector && sector+count > nextSector);
+  nextSector = block->endSector;
+  block->stream = sequential;
+
+  return RES_OK;
 }
 
 DRESULT DiskCache::write(BYTE drv, const BYTE* buff, DWORD sector, UINT count)
 {
+#if defined(SIMU)
+  if (traceFile) {
+    fprintf(traceFile, "W %u %u\n", (uint32_t)sector, (uint32_t)count);
+  }
+#endif
   ++stats.noWrites;
   for(int n=0; n < DISK_CACHE_BLOCKS_NUM; ++n) {
     blocks[n].free(sector, count);
@@ -168,6 +306,30 @@ int DiskCache::getHitRate() const
   return (stats.noHits * 1000) / all;
 }
 
+int DiskCache::getHitRate(uint8_t client) const
+{
+  const DiskCacheClientStats & clientStats = stats.clients[client];
+  uint32_t all = clientStats.noHits + clientStats.noMisses;
+  if (all == 0) return 0;
+  return (clientStats.noHits * 1000) / all;
+}
+
+#if defined(SIMU)
+void DiskCache::startTrace(const char * path)
+{
+  stopTrace();
+  traceFile = fopen(path, "w");
+}
+
+void DiskCache::stopTrace()
+{
+  if (traceFile) {
+    fclose(traceFile);
+    traceFile = NULL;
+  }
+}
+#endif
+
 DRESULT disk_read(BYTE drv, BYTE * buff, DWORD sector, UINT count)
 {
   return diskCache.read(drv, buff, sector, count);
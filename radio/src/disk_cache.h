@@ -24,12 +24,26 @@
 #include "diskio.h"
 #include "sdio_sd.h"
 
+#if defined(SIMU)
+  #include <stdio.h>
+#endif
+
 // tunable parameters
 #define DISK_CACHE_BLOCKS_NUM      32   // no cache blocks
 #define DISK_CACHE_BLOCK_SECTORS   16   // no sectors
+#define DISK_CACHE_PINNED_MAX      8    // max cache blocks pinned for FAT / directories
 
 #define DISK_CACHE_BLOCK_SIZE   (DISK_CACHE_BLOCK_SECTORS * BLOCK_SIZE)
 
+enum DiskCacheClient
+{
+  DISK_CACHE_CLIENT_OTHER,
+  DISK_CACHE_CLIENT_AUDIO,
+  DISK_CACHE_CLIENT_LUA,
+  DISK_CACHE_CLIENT_BITMAPS,
+  DISK_CACHE_CLIENTS_COUNT
+};
+
 class DiskCacheBlock
 {
 public:
@@ -40,17 +54,32 @@ public:
   void free();
   bool empty() const;
 
+  uint32_t lastUse;      // DiskCache clock value at the last access, for LRU
+  bool pinned;           // holds FAT / directory sectors
+  bool readAhead;        // filled by read-ahead, not yet accessed
+  bool stream;           // part of a sequential stream, the next block is read when its end is reached
+
 private:
+  friend class DiskCache;
   uint8_t data[DISK_CACHE_BLOCK_SIZE];
   DWORD startSector;
   DWORD endSector;
 };
 
+struct DiskCacheClientStats
+{
+  uint32_t noHits;
+  uint32_t noMisses;
+};
+
 struct DiskCacheStats
 {
   uint32_t noHits;
   uint32_t noMisses;
   uint32_t noWrites;
+  uint32_t noReadAheads;
+  uint32_t noReadAheadHits;
+  DiskCacheClientStats clients[DISK_CACHE_CLIENTS_COUNT];
 };
 
 class DiskCache
@@ -58,15 +87,38 @@ class DiskCache
   public:
     DiskCache();
     DRESULT read(BYTE drv, BYTE* buff, DWORD sector, UINT count);
+    DRESULT read(BYTE drv, BYTE* buff, DWORD sector, UINT count, uint8_t client, bool metadata);
     DRESULT write(BYTE drv, const BYTE* buff, DWORD sector, UINT count);
     const DiskCacheStats & getStats() const;
     int getHitRate() const;
+    int getHitRate(uint8_t client) const;
     void clear();
 
+    // client of the next reads from the menus task, audio reads are identified by their task
+    void setClient(uint8_t client)
+    {
+      this->client = client;
+    }
+
+#if defined(SIMU)
+    // record all reads / writes to replay them in tests/disk_cache.cpp
+    void startTrace(const char * path);
+    void stopTrace();
+#endif
+
   private:
+    DiskCacheBlock * getVictim();
+    void pin(DiskCacheBlock * block);
+    void prefetch(BYTE drv, DWORD sector);
+
     DiskCacheStats stats;
-    uint32_t lastBlock;
+    uint32_t clock;
+    uint8_t client;
+    DWORD nextSequentialSector[DISK_CACHE_CLIENTS_COUNT];
     DiskCacheBlock * blocks;
+#if defined(SIMU)
+    FILE * traceFile;
+#endif
 };
 
 extern DiskCache diskCache;
@@ -34,6 +34,30 @@ extern const uint8_t * const fontsTable[1];
 #if defined(PCBHORUS)
 extern BitmapBuffer * fontCache[2];
 void loadFontCache();
+
+#if !defined(BOOT)
+#define GLYPH_ATLASES_COUNT            6
+#define FONT_GLYPHS_MAX                160
+#define TEXT_RUNS_COUNT                32
+#define TEXT_RUN_MAX_LEN               32
+
+// Glyphs pre-rendered over a plain background, one atlas per font / foreground / background
+const BitmapBuffer * getGlyphAtlas(uint8_t fontindex, display_t fg, display_t bg, uint8_t glyph);
+
+// Text runs already drawn over a plain background, reused as a whole
+const BitmapBuffer * findTextRun(uint8_t fontindex, display_t fg, display_t bg, const uint8_t * glyphs, uint8_t len);
+BitmapBuffer * newTextRun(uint8_t fontindex, display_t fg, display_t bg, const uint8_t * glyphs, uint8_t len, coord_t width, coord_t height);
+void clearTextCache();
+
+struct TextCacheStats
+{
+  uint32_t runHits;
+  uint32_t runMisses;
+  uint32_t glyphsRendered;
+};
+
+extern TextCacheStats textCacheStats;
+#endif
 #endif
 
 #else
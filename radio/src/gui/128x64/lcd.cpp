@@ -27,6 +27,38 @@ void lcdClear()
   memset(displayBuf, 0, DISPLAY_BUFFER_SIZE);
 }
 
+#if defined(PCBTARANIS)
+// Checksums of the pages sent by the last refresh. Screens are redrawn from
+// scratch, so the content is compared to find the pages which really changed.
+static uint32_t lcdPageChecksums[LCD_PAGES];
+static bool lcdPageChecksumsValid = false;
+
+void lcdInvalidate()
+{
+  lcdPageChecksumsValid = false;
+}
+
+uint8_t lcdGetDirtyPages()
+{
+  uint8_t result = 0;
+  const display_t * p = displayBuf;
+  for (uint8_t page=0; page<LCD_PAGES; page++) {
+    uint32_t checksum = 2166136261u;
+    for (unsigned int i=0; i<DISPLAY_BUFFER_SIZE/LCD_PAGES; i+=4, p+=4) {
+      uint32_t word;
+      memcpy(&word, p, sizeof(word));
+      checksum = (checksum ^ word) * 16777619u;
+    }
+    if (!lcdPageChecksumsValid || checksum != lcdPageChecksums[page]) {
+      lcdPageChecksums[page] = checksum;
+      result |= (1 << page);
+    }
+  }
+  lcdPageChecksumsValid = true;
+  return result;
+}
+#endif
+
 coord_t lcdLastRightPos;
 coord_t lcdNextPos;
 #if defined(CPUARM)
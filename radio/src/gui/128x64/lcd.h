@@ -263,6 +263,12 @@ void lcd_imgfar(coord_t x, coord_t y, const uint_farptr_t img, uint8_t idx, LcdF
 #endif
 
 void lcdClear(void);
+
+#if defined(PCBTARANIS)
+#define LCD_PAGES                      (LCD_H/8)
+uint8_t lcdGetDirtyPages();            // the pages changed since the last call, one bit per page
+void lcdInvalidate();                  // the next refresh sends all pages
+#endif
 void lcdDraw1bitBitmap(coord_t x, coord_t y, const pm_uchar * img, uint8_t idx, LcdFlags att=0);
 inline void lcdDrawBitmap(coord_t x, coord_t y, const uint8_t * bitmap)
 {
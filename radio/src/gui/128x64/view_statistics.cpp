@@ -120,6 +120,10 @@ void menuStatisticsView(event_t event)
   #define MENU_DEBUG_Y_CURRENT         (1*FH)
   #define MENU_DEBUG_ROW1              (1*FH+1)
   #define MENU_DEBUG_ROW2              (2*FH+1)
+  #define MENU_DEBUG_ROW3              (3*FH+1)
+  #define MENU_DEBUG_ROW4              (4*FH+1)
+  #define MENU_DEBUG_ROW5              (5*FH+1)
+  #define MENU_DEBUG_ROW6              (6*FH+1)
   #define MENU_DEBUG_Y_MAH             (2*FH)
   #define MENU_DEBUG_Y_CPU_TEMP        (3*FH)
   #define MENU_DEBUG_Y_COPROC          (4*FH)
@@ -128,6 +132,7 @@ void menuStatisticsView(event_t event)
   #define MENU_DEBUG_Y_USB             (2*FH)
   #define MENU_DEBUG_Y_LUA             (3*FH)
   #define MENU_DEBUG_Y_FREE_RAM        (4*FH)
+  #define MENU_DEBUG_Y_EEPROM          (1*FH)
 #else
   #define MENU_DEBUG_COL1_OFS          (14*FW)
 #endif
@@ -156,6 +161,12 @@ void menuStatisticsDebug(event_t event)
       g_tmr1Latency_max = 0;
 #endif
       maxMixerDuration  = 0;
+#if defined(CPUARM)
+      profiler.reset();
+#endif
+#if defined(PCBTARANIS) && defined(EEPROM_RLC)
+      memclear(&eepromStats, sizeof(eepromStats));
+#endif
       break;
 
 
@@ -235,6 +246,14 @@ void menuStatisticsDebug(event_t event)
   lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_Y_USB, APP_Rx_ptr_out, LEFT);
   lcdDrawText(lcdLastRightPos, MENU_DEBUG_Y_USB, " ");
   lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_Y_USB, usbWraps, LEFT);
+#endif
+#if defined(EEPROM_RLC)
+  // bytes written and percentage of the bytes which were already in the EEPROM
+  lcdDrawTextAlignedLeft(MENU_DEBUG_Y_EEPROM, "Eeprom wr");
+  lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_Y_EEPROM, eepromStats.bytes, LEFT);
+  lcdDrawText(lcdLastRightPos, MENU_DEBUG_Y_EEPROM, "b ");
+  lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_Y_EEPROM, eepromStats.skippedBytes ? 100 * (uint64_t)eepromStats.skippedBytes / (eepromStats.skippedBytes + eepromStats.bytes) : 0, LEFT);
+  lcdDrawText(lcdLastRightPos, MENU_DEBUG_Y_EEPROM, "%");
 #endif
   lcdDrawTextAlignedLeft(MENU_DEBUG_Y_FREE_RAM, "Free Mem");
   lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_Y_FREE_RAM, availableMemory(), LEFT);
@@ -316,6 +335,34 @@ void menuStatisticsDebug2(event_t event)
   lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW2, IS_BLUETOOTH_CHIP_PRESENT(), RIGHT);
 #endif
 
+  // Profiler, CPU load of the mixer/menus/audio/Lua
+  lcdDrawTextAlignedLeft(MENU_DEBUG_ROW3, "Load %");
+  lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW3, profiler.getTaskLoad(PROFILER_TASK_MIXER)/10, LEFT);
+  for (uint8_t i=PROFILER_TASK_MENUS; i<PROFILER_TASKS_COUNT; i++) {
+    lcdDrawText(lcdLastRightPos, MENU_DEBUG_ROW3, "/");
+    lcdDrawNumber(lcdLastRightPos+1, MENU_DEBUG_ROW3, profiler.getTaskLoad(i)/10, LEFT);
+  }
+
+  lcdDrawTextAlignedLeft(MENU_DEBUG_ROW4, "Mix p50/99");
+  lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW4, profiler.mixerDuration.getPercentile(50), LEFT);
+  lcdDrawText(lcdLastRightPos, MENU_DEBUG_ROW4, "/");
+  lcdDrawNumber(lcdLastRightPos+1, MENU_DEBUG_ROW4, profiler.mixerDuration.getPercentile(99), LEFT);
+  lcdDrawText(lcdLastRightPos, MENU_DEBUG_ROW4, "us");
+
+  lcdDrawTextAlignedLeft(MENU_DEBUG_ROW5, "Pls p50/99");
+  lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW5, profiler.mixerToPulses.getPercentile(50), LEFT);
+  lcdDrawText(lcdLastRightPos, MENU_DEBUG_ROW5, "/");
+  lcdDrawNumber(lcdLastRightPos+1, MENU_DEBUG_ROW5, profiler.mixerToPulses.getPercentile(99), LEFT);
+  lcdDrawText(lcdLastRightPos, MENU_DEBUG_ROW5, "us");
+
+  // average duration of each mixer stage: Inputs, logical Switches, Mixes, Functions, Limits, Clocks (timers), Telemetry
+  coord_t x = 0;
+  for (uint8_t i=PROFILER_STAGE_NONE+1; i<PROFILER_STAGES_COUNT; i++) {
+    lcdDrawSizedText(x, MENU_DEBUG_ROW6+1, &"-ISMFLCT"[i], 1, SMLSIZE);
+    lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW6+1, profiler.getStageAverage(i), LEFT|SMLSIZE);
+    x = lcdLastRightPos + 2;
+  }
+
   lcdDrawText(4*FW, 7*FH+1, STR_MENUTORESET);
   lcdInvertLastLine();
 }
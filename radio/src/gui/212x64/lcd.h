@@ -189,6 +189,12 @@ void lcdDrawBitmap(coord_t x, coord_t y, const uint8_t * img, coord_t offset=0,
 
 void lcdClear();
 
+#if defined(PCBTARANIS)
+#define LCD_PAGES                      (LCD_H/8)
+uint8_t lcdGetDirtyPages();            // the pages changed since the last call, one bit per page
+void lcdInvalidate();                  // the next refresh sends all pages
+#endif
+
 uint8_t * lcdLoadBitmap(uint8_t * dest, const char * filename, uint16_t width, uint16_t height);
 const char * writeScreenshot();
 
@@ -39,6 +39,7 @@ void displayPresetChoice(event_t event)
     if (crv.type == CURVE_TYPE_CUSTOM) {
       resetCustomCurveX(points, 5+crv.points);
     }
+    storageDirty(EE_MODEL);
   }
 }
 
@@ -52,6 +53,7 @@ void onCurveOneMenu(const char * result)
     int8_t * points = curveAddress(s_curveChan);
     for (int i=0; i<5+crv.points; i++)
       points[i] = -points[i];
+    storageDirty(EE_MODEL);
   }
   else if (result == STR_CLEAR) {
     CurveInfo & crv = g_model.curves[s_curveChan];
@@ -61,6 +63,7 @@ void onCurveOneMenu(const char * result)
     if (crv.type == CURVE_TYPE_CUSTOM) {
       resetCustomCurveX(points, 5+crv.points);
     }
+    storageDirty(EE_MODEL);
   }
 }
 
@@ -96,6 +99,7 @@ void menuModelCurveOne(event_t event)
           resetCustomCurveX(points, 5 + crv.points);
         }
         crv.type = newType;
+        storageDirty(EE_MODEL);
       }
     }
   }
@@ -120,6 +124,7 @@ void menuModelCurveOne(event_t event)
             points[5 + count + i - 1] = getCurveX(5 + count, i);
         }
         crv.points = count;
+        storageDirty(EE_MODEL);
       }
     }
   }
@@ -172,7 +172,7 @@ void menuModelSensor(event_t event)
           if (attr) {
             switch (menuHorizontalPosition) {
               case 0:
-                sensor->id = checkIncDec(event, sensor->id, 0x0000, 0xffff, INCDEC_REP10|NO_INCDEC_MARKS);
+                sensor->id = checkIncDec(event, sensor->id, 0x0000, 0xffff, EE_MODEL|INCDEC_REP10|NO_INCDEC_MARKS);
                 break;
 
               case 1:
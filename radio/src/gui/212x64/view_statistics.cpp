@@ -130,6 +130,10 @@ void menuStatisticsDebug(event_t event)
       maxLuaDuration = 0;
 #endif
       maxMixerDuration  = 0;
+      profiler.reset();
+#if defined(EEPROM_RLC)
+      memclear(&eepromStats, sizeof(eepromStats));
+#endif
       break;
 
     case EVT_KEY_FIRST(KEY_DOWN):
@@ -182,6 +186,13 @@ void menuStatisticsDebug(event_t event)
   lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW4, APP_Rx_ptr_out, LEFT);
   lcdDrawText(lcdLastRightPos, MENU_DEBUG_ROW4, " ");
   lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW4, usbWraps, LEFT);
+#elif defined(EEPROM_RLC)
+  lcdDrawTextAlignedLeft(MENU_DEBUG_ROW4, "Eeprom");
+  lcdDrawText(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW4+1, "[Written]", SMLSIZE);
+  lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW4, eepromStats.bytes, LEFT);
+  lcdDrawText(lcdLastRightPos+2, MENU_DEBUG_ROW4+1, "[Unchanged]", SMLSIZE);
+  lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW4, eepromStats.skippedBytes ? 100 * (uint64_t)eepromStats.skippedBytes / (eepromStats.skippedBytes + eepromStats.bytes) : 0, LEFT);
+  lcdDrawText(lcdLastRightPos, MENU_DEBUG_ROW4, "%");
 #endif
 
   lcdDrawTextAlignedLeft(MENU_DEBUG_ROW5, STR_FREESTACKMINB);
@@ -236,6 +247,41 @@ void menuStatisticsDebug2(event_t event)
   lcdDrawTextAlignedLeft(MENU_DEBUG_ROW1, "Tlm RX Err");
   lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW1, telemetryErrors, RIGHT);
 
+  // Profiler
+  lcdDrawTextAlignedLeft(MENU_DEBUG_ROW2, "CPU load");
+  lcdDrawText(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW2+1, "[X]", SMLSIZE);
+  lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW2, profiler.getTaskLoad(PROFILER_TASK_MIXER)/10, LEFT);
+  lcdDrawText(lcdLastRightPos+2, MENU_DEBUG_ROW2+1, "[M]", SMLSIZE);
+  lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW2, profiler.getTaskLoad(PROFILER_TASK_MENUS)/10, LEFT);
+  lcdDrawText(lcdLastRightPos+2, MENU_DEBUG_ROW2+1, "[A]", SMLSIZE);
+  lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW2, profiler.getTaskLoad(PROFILER_TASK_AUDIO)/10, LEFT);
+  lcdDrawText(lcdLastRightPos+2, MENU_DEBUG_ROW2+1, "[L]", SMLSIZE);
+  lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW2, profiler.getTaskLoad(PROFILER_TASK_LUA)/10, LEFT);
+  lcdDrawText(lcdLastRightPos, MENU_DEBUG_ROW2, "%");
+
+  lcdDrawTextAlignedLeft(MENU_DEBUG_ROW3, "Mixer");
+  lcdDrawText(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW3+1, "[p50]", SMLSIZE);
+  lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW3, profiler.mixerDuration.getPercentile(50), LEFT);
+  lcdDrawText(lcdLastRightPos+2, MENU_DEBUG_ROW3+1, "[p99]", SMLSIZE);
+  lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW3, profiler.mixerDuration.getPercentile(99), LEFT);
+  lcdDrawText(lcdLastRightPos, MENU_DEBUG_ROW3, "us");
+
+  lcdDrawTextAlignedLeft(MENU_DEBUG_ROW4, "Mix>pulses");
+  lcdDrawText(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW4+1, "[p50]", SMLSIZE);
+  lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW4, profiler.mixerToPulses.getPercentile(50), LEFT);
+  lcdDrawText(lcdLastRightPos+2, MENU_DEBUG_ROW4+1, "[p99]", SMLSIZE);
+  lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW4, profiler.mixerToPulses.getPercentile(99), LEFT);
+  lcdDrawText(lcdLastRightPos, MENU_DEBUG_ROW4, "us");
+
+  // average duration of each mixer stage: Inputs, logical Switches, Mixes, Functions, Limits, Clocks (timers), Telemetry
+  lcdDrawTextAlignedLeft(MENU_DEBUG_ROW5, "Stages us");
+  coord_t x = MENU_DEBUG_COL1_OFS;
+  for (uint8_t i=PROFILER_STAGE_NONE+1; i<PROFILER_STAGES_COUNT; i++) {
+    lcdDrawSizedText(x, MENU_DEBUG_ROW5+1, &"-ISMFLCT"[i], 1, SMLSIZE);
+    lcdDrawNumber(lcdLastRightPos, MENU_DEBUG_ROW5, profiler.getStageAverage(i), LEFT);
+    x = lcdLastRightPos + 2;
+  }
+
 
   lcdDrawText(3*FW, 7*FH+1, STR_MENUTORESET);
   lcdInvertLastLine();
@@ -308,6 +308,95 @@ uint8_t BitmapBuffer::drawCharWithCache(coord_t x, coord_t y, const BitmapBuffer
   return width;
 }
 
+bool BitmapBuffer::isUniform(coord_t x, coord_t y, coord_t w, coord_t h, display_t color) const
+{
+  for (coord_t row=0; row<h; row++) {
+    const display_t * p = getPixelPtr(x, y+row);
+    for (coord_t col=0; col<w; col++) {
+      if (*p != color) {
+        return false;
+      }
+      MOVE_TO_NEXT_RIGHT_PIXEL(p);
+    }
+  }
+  return true;
+}
+
+#if !defined(BOOT)
+// Draws a text without positioning chars over a plain background, as one blit when the same text
+// was already drawn with the same font and colors, from the glyphs atlas otherwise
+bool BitmapBuffer::drawTextRun(coord_t x, coord_t y, const char * s, uint8_t len, LcdFlags flags)
+{
+  uint32_t fontindex = FONTINDEX(flags);
+  if (fontindex == XXLSIZE_INDEX) {
+    return false;
+  }
+
+  const uint8_t * font = fontsTable[fontindex];
+  const uint16_t * fontspecs = fontspecsTable[fontindex];
+  coord_t height = *(((uint16_t *)font)+1);
+
+  uint8_t glyphs[TEXT_RUN_MAX_LEN];
+  uint8_t count = 0;
+  coord_t width = 0;
+  while (len--) {
+    unsigned char c = (flags & ZCHAR) ? idx2char(*s) : *s;
+    if (!c) {
+      break;
+    }
+    if (c < 0x20 || count == TEXT_RUN_MAX_LEN) {
+      return false;
+    }
+    uint8_t glyph = getMappedChar(c);
+    if (glyph >= FONT_GLYPHS_MAX) {
+      return false;
+    }
+    glyphs[count++] = glyph;
+    width += fontspecs[glyph+1] - fontspecs[glyph];
+    s++;
+  }
+
+  // glyphs are drawn one pixel on the left
+  coord_t left = x - 1;
+  if (width == 0 || left < 0 || y < 0 || left + width > this->width || y + height > this->height) {
+    return false;
+  }
+
+  display_t fg = lcdColorTable[COLOR_IDX(flags)];
+  display_t bg = *getPixelPtr(left, y);
+  if (!isUniform(left, y, width, height, bg)) {
+    return false;
+  }
+
+  const BitmapBuffer * run = findTextRun(fontindex, fg, bg, glyphs, count);
+  if (run) {
+    drawBitmap(left, y, run);
+  }
+  else {
+    coord_t pos = left;
+    for (uint8_t i=0; i<count; i++) {
+      coord_t offset = fontspecs[glyphs[i]];
+      coord_t w = fontspecs[glyphs[i]+1] - offset;
+      if (w > 0) {
+        const BitmapBuffer * atlas = getGlyphAtlas(fontindex, fg, bg, glyphs[i]);
+        if (atlas)
+          drawBitmap(pos, y, atlas, offset, 0, w);
+        else
+          drawBitmapPattern(pos, y, font, flags, offset, w);
+        pos += w;
+      }
+    }
+    BitmapBuffer * cache = newTextRun(fontindex, fg, bg, glyphs, count, width, height);
+    if (cache) {
+      cache->drawBitmap(0, 0, this, left, y, width, height);
+    }
+  }
+
+  lcdNextPos = x + width;
+  return true;
+}
+#endif
+
 void BitmapBuffer::drawSizedText(coord_t x, coord_t y, const char * s, uint8_t len, LcdFlags flags)
 {
 #define INCREMENT_POS(delta) \
@@ -379,6 +468,13 @@ void BitmapBuffer::drawSizedText(coord_t x, coord_t y, const char * s, uint8_t l
     }
   }
 
+#if !defined(BOOT)
+  // the inverted STDSIZE font cache also draws the background
+  if (!(flags & (NO_FONTCACHE | VERTICAL)) && !((flags & INVERS) && fontcache) && drawTextRun(x, y, s, len, flags)) {
+    return;
+  }
+#endif
+
   bool setpos = false;
   const coord_t orig_pos = pos;
   while (len--) {
@@ -491,11 +587,22 @@ void BitmapBuffer::drawBitmapPatternPie(coord_t x0, coord_t y0, const uint8_t *
 
 BitmapBuffer * BitmapBuffer::load(const char * filename)
 {
+#if defined(DISK_CACHE)
+  diskCache.setClient(DISK_CACHE_CLIENT_BITMAPS);
+#endif
+
+  BitmapBuffer * bitmap;
   const char * ext = getFileExtension(filename);
   if (ext && !strcmp(ext, ".bmp"))
-    return load_bmp(filename);
+    bitmap = load_bmp(filename);
   else
-    return load_stb(filename);
+    bitmap = load_stb(filename);
+
+#if defined(DISK_CACHE)
+  diskCache.setClient(DISK_CACHE_CLIENT_OTHER);
+#endif
+
+  return bitmap;
 }
 
 BitmapBuffer * BitmapBuffer::loadMask(const char * filename)
@@ -324,9 +324,12 @@ class BitmapBuffer: public BitmapBufferBase<uint16_t>
       drawBitmap(x + xshift, y + yshift, bitmap, 0, 0, 0, 0, scale);
     }
 
+    bool isUniform(coord_t x, coord_t y, coord_t w, coord_t h, display_t color) const;
+
   protected:
     static BitmapBuffer * load_bmp(const char * filename);
     static BitmapBuffer * load_stb(const char * filename);
+    bool drawTextRun(coord_t x, coord_t y, const char * s, uint8_t len, LcdFlags flags);
 };
 
 extern BitmapBuffer * lcd;
@@ -117,3 +117,150 @@ void loadFontCache()
   fontCache[0] = createFontCache(fontsTable[0], TEXT_COLOR, TEXT_BGCOLOR);
   fontCache[1] = createFontCache(fontsTable[0], TEXT_INVERTED_COLOR, TEXT_INVERTED_BGCOLOR);
 }
+
+#if !defined(BOOT)
+struct GlyphAtlas
+{
+  BitmapBuffer * bitmap;
+  uint8_t fontindex;
+  display_t fg;
+  display_t bg;
+  uint32_t lastUse;
+  uint8_t rendered[FONT_GLYPHS_MAX / 8];
+};
+
+struct TextRun
+{
+  BitmapBuffer * bitmap;
+  uint8_t fontindex;
+  display_t fg;
+  display_t bg;
+  uint8_t len;
+  uint8_t glyphs[TEXT_RUN_MAX_LEN];
+  uint32_t lastUse;
+};
+
+static GlyphAtlas glyphAtlases[GLYPH_ATLASES_COUNT];
+static TextRun textRuns[TEXT_RUNS_COUNT];
+static uint32_t textCacheTime;
+TextCacheStats textCacheStats;
+
+static void renderGlyph(GlyphAtlas & atlas, uint8_t glyph)
+{
+  const uint8_t * font = fontsTable[atlas.fontindex];
+  const uint16_t * spec = fontspecsTable[atlas.fontindex];
+  coord_t w = *((uint16_t *)font);
+  coord_t height = *(((uint16_t *)font)+1);
+  coord_t offset = spec[glyph];
+  coord_t width = spec[glyph+1] - offset;
+
+  // same blending as drawBitmapPattern() over the background color
+  for (coord_t row=0; row<height; row++) {
+    const uint8_t * q = font + 4 + row*w + offset;
+    for (coord_t col=0; col<width; col++) {
+      atlas.bitmap->drawPixel(offset+col, row, atlas.bg);
+      atlas.bitmap->drawAlphaPixel(offset+col, row, *q++, atlas.fg);
+    }
+  }
+
+  atlas.rendered[glyph / 8] |= (1 << (glyph % 8));
+  textCacheStats.glyphsRendered++;
+}
+
+const BitmapBuffer * getGlyphAtlas(uint8_t fontindex, display_t fg, display_t bg, uint8_t glyph)
+{
+  if (glyph >= FONT_GLYPHS_MAX)
+    return NULL;
+
+  GlyphAtlas * atlas = NULL;
+  GlyphAtlas * oldest = &glyphAtlases[0];
+  for (int i=0; i<GLYPH_ATLASES_COUNT; i++) {
+    GlyphAtlas & entry = glyphAtlases[i];
+    if (entry.bitmap && entry.fontindex == fontindex && entry.fg == fg && entry.bg == bg) {
+      atlas = &entry;
+      break;
+    }
+    if (!entry.bitmap || (oldest->bitmap && entry.lastUse < oldest->lastUse)) {
+      oldest = &entry;
+    }
+  }
+
+  if (!atlas) {
+    const uint8_t * font = fontsTable[fontindex];
+    atlas = oldest;
+    delete atlas->bitmap;
+    memclear(atlas, sizeof(GlyphAtlas));
+    atlas->bitmap = new BitmapBuffer(BMP_RGB565, *((uint16_t *)font), *(((uint16_t *)font)+1));
+    if (!atlas->bitmap || !atlas->bitmap->getData()) {
+      delete atlas->bitmap;
+      atlas->bitmap = NULL;
+      return NULL;
+    }
+    atlas->fontindex = fontindex;
+    atlas->fg = fg;
+    atlas->bg = bg;
+  }
+
+  atlas->lastUse = ++textCacheTime;
+  if (!(atlas->rendered[glyph / 8] & (1 << (glyph % 8)))) {
+    renderGlyph(*atlas, glyph);
+  }
+  return atlas->bitmap;
+}
+
+const BitmapBuffer * findTextRun(uint8_t fontindex, display_t fg, display_t bg, const uint8_t * glyphs, uint8_t len)
+{
+  for (int i=0; i<TEXT_RUNS_COUNT; i++) {
+    TextRun & run = textRuns[i];
+    if (run.bitmap && run.len == len && run.fontindex == fontindex && run.fg == fg && run.bg == bg && !memcmp(run.glyphs, glyphs, len)) {
+      run.lastUse = ++textCacheTime;
+      textCacheStats.runHits++;
+      return run.bitmap;
+    }
+  }
+  textCacheStats.runMisses++;
+  return NULL;
+}
+
+BitmapBuffer * newTextRun(uint8_t fontindex, display_t fg, display_t bg, const uint8_t * glyphs, uint8_t len, coord_t width, coord_t height)
+{
+  TextRun * run = &textRuns[0];
+  for (int i=1; i<TEXT_RUNS_COUNT && run->bitmap; i++) {
+    if (!textRuns[i].bitmap || textRuns[i].lastUse < run->lastUse) {
+      run = &textRuns[i];
+    }
+  }
+
+  if (!run->bitmap || run->bitmap->getWidth() != width || run->bitmap->getHeight() != height) {
+    delete run->bitmap;
+    run->bitmap = new BitmapBuffer(BMP_RGB565, width, height);
+    if (run->bitmap && !run->bitmap->getData()) {
+      delete run->bitmap;
+      run->bitmap = NULL;
+    }
+  }
+
+  if (run->bitmap) {
+    run->fontindex = fontindex;
+    run->fg = fg;
+    run->bg = bg;
+    run->len = len;
+    memcpy(run->glyphs, glyphs, len);
+    run->lastUse = ++textCacheTime;
+  }
+  return run->bitmap;
+}
+
+void clearTextCache()
+{
+  for (int i=0; i<GLYPH_ATLASES_COUNT; i++) {
+    delete glyphAtlases[i].bitmap;
+  }
+  for (int i=0; i<TEXT_RUNS_COUNT; i++) {
+    delete textRuns[i].bitmap;
+  }
+  memclear(glyphAtlases, sizeof(glyphAtlases));
+  memclear(textRuns, sizeof(textRuns));
+  memclear(&textCacheStats, sizeof(textCacheStats));
+}
+#endif
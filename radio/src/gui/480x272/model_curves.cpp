@@ -43,6 +43,7 @@ void displayPresetChoice(event_t event)
     if (crv.type == CURVE_TYPE_CUSTOM) {
       resetCustomCurveX(points, 5+crv.points);
     }
+    storageDirty(EE_MODEL);
   }
 }
 
@@ -56,6 +57,7 @@ void onCurveOneMenu(const char * result)
     int8_t * points = curveAddress(s_curveChan);
     for (int i=0; i<5+crv.points; i++)
       points[i] = -points[i];
+    storageDirty(EE_MODEL);
   }
   else if (result == STR_CLEAR) {
     CurveInfo & crv = g_model.curves[s_curveChan];
@@ -65,6 +67,7 @@ void onCurveOneMenu(const char * result)
     if (crv.type == CURVE_TYPE_CUSTOM) {
       resetCustomCurveX(points, 5+crv.points);
     }
+    storageDirty(EE_MODEL);
   }
 }
 
@@ -125,6 +128,7 @@ bool menuModelCurveOne(event_t event)
           resetCustomCurveX(points, 5 + crv.points);
         }
         crv.type = newType;
+        storageDirty(EE_MODEL);
       }
     }
   }
@@ -148,6 +152,7 @@ bool menuModelCurveOne(event_t event)
             points[5 + count + i - 1] = -100 + (i * 200) / (4 + count);
         }
         crv.points = count;
+        storageDirty(EE_MODEL);
       }
     }
   }
@@ -341,7 +341,8 @@ bool menuModelSelect(event_t event)
 
   switch(event) {
     case 0:
-      // no need to refresh the screen
+      // no need to refresh the screen, the idle time is used to load the next model cells
+      modelslist.prefetch();
       return false;
 
     case EVT_ENTRY:
@@ -140,6 +140,7 @@ void loadTheme(Theme * new_theme)
   TRACE("load theme %s", new_theme->getName());
   theme = new_theme;
   theme->load();
+  invalidateWidgets();
 }
 
 void loadTheme()
@@ -153,5 +154,6 @@ void loadTheme()
   }
   else {
     theme->load();
+    invalidateWidgets();
   }
 }
@@ -215,6 +215,8 @@ bool menuMainView(event_t event)
     }
   }
 
+  widgetsStatsFrame();
+
   return true;
 }
 
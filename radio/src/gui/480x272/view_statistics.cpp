@@ -99,6 +99,7 @@ bool menuStatsDebug(event_t event)
   {
     case EVT_KEY_FIRST(KEY_ENTER):
       maxMixerDuration  = 0;
+      profiler.reset();
 #if defined(LUA)
       maxLuaInterval = 0;
       maxLuaDuration = 0;
@@ -151,6 +152,14 @@ bool menuStatsDebug(event_t event)
 
   lcdDrawText(MENUS_MARGIN_LEFT, MENU_CONTENT_TOP+line*FH, "Tlm RX Errs");
   lcdDrawNumber(MENU_STATS_COLUMN1, MENU_CONTENT_TOP+line*FH, telemetryErrors, LEFT);
+  ++line;
+
+  lcdDrawText(MENUS_MARGIN_LEFT, MENU_CONTENT_TOP+line*FH, "Main view");
+  lcdDrawNumber(MENU_STATS_COLUMN1, MENU_CONTENT_TOP+line*FH, widgetsStats.fps, LEFT, 0, NULL, "fps");
+  lcdDrawText(lcdNextPos+20, MENU_CONTENT_TOP+line*FH+1, "[Redraw]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, MENU_CONTENT_TOP+line*FH, widgetsStats.redrawArea / 1000, LEFT, 0, NULL, "kpx/s");
+  lcdDrawText(lcdNextPos+20, MENU_CONTENT_TOP+line*FH+1, "[Cache]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, MENU_CONTENT_TOP+line*FH, widgetsStats.reusedArea / 1000, LEFT, 0, NULL, "kpx/s");
 
   lcdDrawText(LCD_W/2, MENU_FOOTER_TOP, STR_MENUTORESET, MENU_TITLE_COLOR | CENTERED);
   return true;
@@ -188,6 +197,56 @@ bool menuStatsAnalogs(event_t event)
   return true;
 }
 
+bool menuStatsProfiler(event_t event)
+{
+  switch(event)
+  {
+    case EVT_KEY_FIRST(KEY_ENTER):
+      profiler.reset();
+      memclear(&mixerSchedulerStats, sizeof(mixerSchedulerStats));
+      break;
+  }
+
+  SIMPLE_MENU("Profiler", STATS_ICONS, menuTabStats, e_StatsProfiler, 1);
+
+  lcdDrawText(MENUS_MARGIN_LEFT, MENU_CONTENT_TOP, "CPU load");
+  coord_t x = MENU_STATS_COLUMN1;
+  for (uint8_t i=0; i<PROFILER_TASKS_COUNT; i++) {
+    uint32_t load = profiler.getTaskLoad(i);
+    lcdDrawText(x, MENU_CONTENT_TOP+1, "[", HEADER_COLOR|SMLSIZE);
+    lcdDrawText(lcdNextPos, MENU_CONTENT_TOP+1, profilerTaskNames[i], HEADER_COLOR|SMLSIZE);
+    lcdDrawText(lcdNextPos, MENU_CONTENT_TOP+1, "]", HEADER_COLOR|SMLSIZE);
+    lcdDrawNumber(lcdNextPos+5, MENU_CONTENT_TOP, load, PREC1|LEFT, 0, NULL, "%");
+    x = lcdNextPos + 20;
+  }
+
+  lcdDrawText(MENUS_MARGIN_LEFT, MENU_CONTENT_TOP+FH, "Mixer");
+  lcdDrawText(MENU_STATS_COLUMN1, MENU_CONTENT_TOP+FH+1, "[p50]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, MENU_CONTENT_TOP+FH, profiler.mixerDuration.getPercentile(50), LEFT, 0, NULL, "us");
+  lcdDrawText(lcdNextPos+20, MENU_CONTENT_TOP+FH+1, "[p99]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, MENU_CONTENT_TOP+FH, profiler.mixerDuration.getPercentile(99), LEFT, 0, NULL, "us");
+  lcdDrawText(lcdNextPos+20, MENU_CONTENT_TOP+FH+1, "[Runs]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, MENU_CONTENT_TOP+FH, profiler.mixerRuns, LEFT);
+
+  lcdDrawText(MENUS_MARGIN_LEFT, MENU_CONTENT_TOP+2*FH, "Mixer to pulses");
+  lcdDrawText(MENU_STATS_COLUMN1, MENU_CONTENT_TOP+2*FH+1, "[p50]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, MENU_CONTENT_TOP+2*FH, profiler.mixerToPulses.getPercentile(50), LEFT, 0, NULL, "us");
+  lcdDrawText(lcdNextPos+20, MENU_CONTENT_TOP+2*FH+1, "[p99]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, MENU_CONTENT_TOP+2*FH, profiler.mixerToPulses.getPercentile(99), LEFT, 0, NULL, "us");
+  lcdDrawText(lcdNextPos+20, MENU_CONTENT_TOP+2*FH+1, "[Stale]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, MENU_CONTENT_TOP+2*FH, mixerSchedulerStats.staleFrames, LEFT);
+
+  // average duration of each mixer stage, in two columns
+  for (uint8_t i=PROFILER_STAGE_NONE+1; i<PROFILER_STAGES_COUNT; i++) {
+    coord_t y = MENU_CONTENT_TOP + (3+(i-1)/2)*FH;
+    coord_t col = ((i-1) & 1 ? LCD_W/2 : 0);
+    lcdDrawText(MENUS_MARGIN_LEFT+col, y, profilerStageNames[i]);
+    lcdDrawNumber(MENU_STATS_COLUMN1+col, y, profiler.getStageAverage(i), LEFT, 0, NULL, "us");
+  }
+
+  lcdDrawText(LCD_W/2, MENU_FOOTER_TOP, STR_MENUTORESET, MENU_TITLE_COLOR | CENTERED);
+  return true;
+}
 
 #if defined(DEBUG_TRACE_BUFFER)
 #define STATS_TRACES_INDEX_POS         MENUS_MARGIN_LEFT
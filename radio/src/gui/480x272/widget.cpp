@@ -51,3 +51,69 @@ Widget * loadWidget(const char * name, const Zone & zone, Widget::PersistentData
   }
   return NULL;
 }
+
+static uint32_t widgetsVersion = 1;
+WidgetsStats widgetsStats;
+
+void invalidateWidgets()
+{
+  widgetsVersion++;
+}
+
+ZoneCache::~ZoneCache()
+{
+  delete bitmap;
+}
+
+bool ZoneCache::draw(const Widget * widget)
+{
+  const Zone & current = widget->getZone();
+  if (this->widget != widget || version != widgetsVersion || memcmp(&zone, &current, sizeof(Zone))) {
+    return false;
+  }
+
+  lcd->drawBitmap(zone.x, zone.y, bitmap);
+  widgetsStats.currentReusedArea += zone.w * zone.h;
+  return true;
+}
+
+void ZoneCache::capture(const Widget * widget)
+{
+  const Zone & current = widget->getZone();
+  widgetsStats.currentRedrawArea += current.w * current.h;
+
+  if (!bitmap || bitmap->getWidth() != current.w || bitmap->getHeight() != current.h) {
+    delete bitmap;
+    bitmap = new BitmapBuffer(BMP_RGB565, current.w, current.h);
+    if (bitmap && !bitmap->getData()) {
+      delete bitmap;
+      bitmap = NULL;
+    }
+  }
+
+  if (bitmap) {
+    bitmap->drawBitmap(0, 0, lcd, current.x, current.y, current.w, current.h);
+    this->widget = widget;
+    zone = current;
+    version = widgetsVersion;
+  }
+  else {
+    this->widget = NULL;
+  }
+}
+
+void widgetsStatsFrame()
+{
+  tmr10ms_t now = get_tmr10ms();
+  widgetsStats.frames++;
+  if (now - widgetsStats.periodStart >= 100) {
+    uint32_t period = now - widgetsStats.periodStart;
+    widgetsStats.fps = widgetsStats.frames * 100 / period;
+    widgetsStats.redrawArea = widgetsStats.currentRedrawArea * 100 / period;
+    widgetsStats.reusedArea = widgetsStats.currentReusedArea * 100 / period;
+    widgetsStats.frames = 0;
+    widgetsStats.currentRedrawArea = 0;
+    widgetsStats.currentReusedArea = 0;
+    widgetsStats.periodStart = now;
+  }
+}
@@ -27,6 +27,7 @@
 #define MAX_WIDGET_OPTIONS             5
 
 class WidgetFactory;
+class BitmapBuffer;
 class Widget
 {
   public:
@@ -66,6 +67,18 @@ class Widget
       return &persistentData->options[index];
     }
 
+    inline const Zone & getZone() const
+    {
+      return zone;
+    }
+
+    // Tells whether the inputs drawn by the widget changed since the previous call.
+    // When they didn't, the container reuses the last rendering of the zone
+    virtual bool hasChanged()
+    {
+      return true;
+    }
+
     virtual void refresh() = 0;
 
     virtual void background()
@@ -80,6 +93,53 @@ class Widget
 
 void registerWidget(const WidgetFactory * factory);
 
+// Last rendering of a zone (widget over its background), copied back while the widget doesn't change
+class ZoneCache
+{
+  public:
+    ZoneCache():
+      bitmap(NULL),
+      widget(NULL),
+      version(0)
+    {
+    }
+
+    ~ZoneCache();
+
+    inline void invalidate()
+    {
+      widget = NULL;
+    }
+
+    bool draw(const Widget * widget);
+
+    void capture(const Widget * widget);
+
+  protected:
+    BitmapBuffer * bitmap;
+    const Widget * widget;
+    Zone zone;
+    uint32_t version;
+};
+
+// Invalidates all the zones caches (model, theme or layout options changes)
+void invalidateWidgets();
+
+struct WidgetsStats
+{
+  uint16_t fps;
+  uint32_t redrawArea; // pixels drawn by the widgets each second
+  uint32_t reusedArea; // pixels copied from the zones caches each second
+  uint16_t frames;
+  uint32_t currentRedrawArea;
+  uint32_t currentReusedArea;
+  uint32_t periodStart;
+};
+
+extern WidgetsStats widgetsStats;
+
+void widgetsStatsFrame();
+
 class WidgetFactory
 {
   public:
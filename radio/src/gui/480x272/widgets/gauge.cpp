@@ -24,13 +24,19 @@ class GaugeWidget: public Widget
 {
   public:
     GaugeWidget(const WidgetFactory * factory, const Zone & zone, Widget::PersistentData * persistentData):
-      Widget(factory, zone, persistentData)
+      Widget(factory, zone, persistentData),
+      deps_hash(0)
     {
     }
 
+    virtual bool hasChanged();
+
     virtual void refresh();
 
     static const ZoneOption options[];
+
+  protected:
+    uint32_t deps_hash;
 };
 
 const ZoneOption GaugeWidget::options[] = {
@@ -41,6 +47,16 @@ const ZoneOption GaugeWidget::options[] = {
   { NULL, ZoneOption::Bool }
 };
 
+bool GaugeWidget::hasChanged()
+{
+  uint32_t new_hash = getValue(persistentData->options[0].unsignedValue);
+  if (new_hash != deps_hash) {
+    deps_hash = new_hash;
+    return true;
+  }
+  return false;
+}
+
 void GaugeWidget::refresh()
 {
   mixsrc_t index = persistentData->options[0].unsignedValue;
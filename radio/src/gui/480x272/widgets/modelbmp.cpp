@@ -63,11 +63,22 @@ class ModelBitmapWidget: public Widget
       }
     }
 
-    virtual void refresh()
+    uint32_t getDepsHash() const
     {
       uint32_t new_hash = hash(g_model.header.bitmap, sizeof(g_model.header.bitmap));
       new_hash ^= hash(g_model.header.name, sizeof(g_model.header.name));
       new_hash ^= hash(g_eeGeneral.themeName, sizeof(g_eeGeneral.themeName));
+      return new_hash;
+    }
+
+    virtual bool hasChanged()
+    {
+      return getDepsHash() != deps_hash;
+    }
+
+    virtual void refresh()
+    {
+      uint32_t new_hash = getDepsHash();
       if (new_hash != deps_hash) {
         deps_hash = new_hash;
         refreshBuffer();
@@ -29,10 +29,21 @@ class OutputsWidget: public Widget
 {
   public:
     OutputsWidget(const WidgetFactory * factory, const Zone & zone, Widget::PersistentData * persistentData):
-      Widget(factory, zone, persistentData)
+      Widget(factory, zone, persistentData),
+      deps_hash(0)
     {
     }
 
+    virtual bool hasChanged()
+    {
+      uint32_t new_hash = hash(channelOutputs, sizeof(channelOutputs));
+      if (new_hash != deps_hash) {
+        deps_hash = new_hash;
+        return true;
+      }
+      return false;
+    }
+
     virtual void refresh();
 
     uint8_t drawChannels(const uint16_t & x, const uint16_t & y, const uint16_t & w, const uint16_t & h, const uint8_t & firstChan, const bool & bg_shown, const uint16_t & bg_color)
@@ -83,6 +94,9 @@ class OutputsWidget: public Widget
     }
 
     static const ZoneOption options[];
+
+  protected:
+    uint32_t deps_hash;
 };
 
 const ZoneOption OutputsWidget::options[] = {
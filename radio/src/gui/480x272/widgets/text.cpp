@@ -30,6 +30,12 @@ class TextWidget: public Widget
     {
     }
 
+    virtual bool hasChanged()
+    {
+      // only depends on the options
+      return false;
+    }
+
     virtual void refresh();
 
     static const ZoneOption options[];
@@ -24,13 +24,19 @@ class TimerWidget: public Widget
 {
   public:
     TimerWidget(const WidgetFactory * factory, const Zone & zone, Widget::PersistentData * persistentData):
-      Widget(factory, zone, persistentData)
+      Widget(factory, zone, persistentData),
+      deps_hash(0)
     {
     }
 
+    virtual bool hasChanged();
+
     virtual void refresh();
 
     static const ZoneOption options[];
+
+  protected:
+    uint32_t deps_hash;
 };
 
 const ZoneOption TimerWidget::options[] = {
@@ -38,6 +44,16 @@ const ZoneOption TimerWidget::options[] = {
   { NULL, ZoneOption::Bool }
 };
 
+bool TimerWidget::hasChanged()
+{
+  uint32_t new_hash = timersStates[persistentData->options[0].unsignedValue].val;
+  if (new_hash != deps_hash) {
+    deps_hash = new_hash;
+    return true;
+  }
+  return false;
+}
+
 void TimerWidget::refresh()
 {
   uint32_t index = persistentData->options[0].unsignedValue;
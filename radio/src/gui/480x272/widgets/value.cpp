@@ -24,13 +24,19 @@ class ValueWidget: public Widget
 {
   public:
     ValueWidget(const WidgetFactory * factory, const Zone & zone, Widget::PersistentData * persistentData):
-      Widget(factory, zone, persistentData)
+      Widget(factory, zone, persistentData),
+      deps_hash(0)
     {
     }
 
+    virtual bool hasChanged();
+
     virtual void refresh();
 
     static const ZoneOption options[];
+
+  protected:
+    uint32_t deps_hash;
 };
 
 const ZoneOption ValueWidget::options[] = {
@@ -40,6 +46,36 @@ const ZoneOption ValueWidget::options[] = {
   { NULL, ZoneOption::Bool }
 };
 
+bool ValueWidget::hasChanged()
+{
+  mixsrc_t field = persistentData->options[0].unsignedValue;
+  uint32_t new_hash;
+
+  if (field >= MIXSRC_FIRST_TIMER && field <= MIXSRC_LAST_TIMER) {
+    new_hash = timersStates[field-MIXSRC_FIRST_TIMER].val;
+  }
+  else if (field >= MIXSRC_FIRST_TELEM) {
+    // GPS, cells and date-time sensors are displayed from more than their value
+    TelemetryItem & telemetryItem = telemetryItems[(field-MIXSRC_FIRST_TELEM)/3];
+    int32_t values[4] = { telemetryItem.value, telemetryItem.valueMin, telemetryItem.valueMax, telemetryItem.isAvailable() + 2*telemetryItem.isOld() };
+    new_hash = hash(values, sizeof(values)) ^ hash(&telemetryItem.cells, sizeof(telemetryItem.cells));
+  }
+#if defined(INTERNAL_GPS)
+  else if (field == MIXSRC_TX_GPS) {
+    new_hash = hash(&gpsData, sizeof(gpsData));
+  }
+#endif
+  else {
+    new_hash = getValue(field);
+  }
+
+  if (new_hash != deps_hash) {
+    deps_hash = new_hash;
+    return true;
+  }
+  return false;
+}
+
 void ValueWidget::refresh()
 {
   const int NUMBERS_PADDING = 4;
@@ -66,6 +66,7 @@ class WidgetsContainer: public WidgetsContainerInterface
       persistentData(persistentData)
     {
       widgets = (Widget **)calloc(N, sizeof(Widget *));
+      caches = new ZoneCache[N];
     }
 
     virtual ~WidgetsContainer()
@@ -76,11 +77,13 @@ class WidgetsContainer: public WidgetsContainerInterface
         }
         free(widgets);
       }
+      delete [] caches;
     }
 
     virtual void createWidget(unsigned int index, const WidgetFactory * factory)
     {
       if (widgets) {
+        caches[index].invalidate();
         memset(persistentData->zones[index].widgetName, 0, sizeof(persistentData->zones[index].widgetName));
         if (factory) {
           strncpy(persistentData->zones[index].widgetName, factory->getName(), sizeof(persistentData->zones[index].widgetName));
@@ -102,6 +105,7 @@ class WidgetsContainer: public WidgetsContainerInterface
       if (widgets) {
         unsigned int count = getZonesCount();
         for (unsigned int i=0; i<count; i++) {
+          caches[i].invalidate();
           delete widgets[i];
           if (persistentData->zones[i].widgetName[0]) {
             char name[sizeof(persistentData->zones[i].widgetName)+1];
@@ -130,7 +134,7 @@ class WidgetsContainer: public WidgetsContainerInterface
       if (widgets) {
         for (int i=0; i<N; i++) {
           if (widgets[i]) {
-            widgets[i]->refresh();
+            refreshZone(i);
           }
         }
       }
@@ -149,6 +153,17 @@ class WidgetsContainer: public WidgetsContainerInterface
 
   protected:
     PersistentData * persistentData;
+    ZoneCache * caches;
+
+    // Damaged zones are redrawn, the others are copied from their last rendering
+    void refreshZone(unsigned int index)
+    {
+      Widget * widget = widgets[index];
+      if (widget->hasChanged() || !caches[index].draw(widget)) {
+        widget->refresh();
+        caches[index].capture(widget);
+      }
+    }
 };
 
 #endif // _WIDGETS_CONTAINER_H_
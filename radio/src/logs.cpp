@@ -27,6 +27,161 @@ uint8_t logDelay;
 
 void writeHeader();
 
+#if defined(LOG_BINARY)
+// Binary logs, turned back into CSV by radio/util/logbin2csv.py
+// Each time the log file is opened, and each time the logged sensors change, a header is written:
+//   "OTXL", version, {type, prec} for each field, LOG_FIELD_END, CSV header line
+// then each record is LOG_RECORD_TAG followed by the fields (little endian).
+// Records are collected in two RAM buffers; a full buffer is written to the
+// SD card on the next tick without a record, in chunks ending on a sector boundary.
+#define LOG_BINARY_VERSION             1
+#define LOG_RECORD_TAG                 0x01
+#define LOGS_BUFFER_SIZE               512
+
+enum LogFieldType {
+  LOG_FIELD_END,
+  LOG_FIELD_DATE,                      // year:16 month:8 day:8 hour:8 min:8 sec:8 ms100:8 (2 columns)
+  LOG_FIELD_TIME,                      // tmr10ms:32
+  LOG_FIELD_VALUE,                     // value:32
+  LOG_FIELD_GPS,                       // latitude:32 longitude:32
+  LOG_FIELD_DATETIME,                  // year:16 month:8 day:8 hour:8 min:8 sec:8 spare:8
+  LOG_FIELD_ANALOG,                    // value:16
+  LOG_FIELD_SWITCH,                    // position:8
+  LOG_FIELD_LOGICAL_SWITCHES,          // ls32-63:32 ls0-31:32
+};
+
+PACK(struct LogDate {
+  uint16_t year;
+  uint8_t month;
+  uint8_t day;
+  uint8_t hour;
+  uint8_t min;
+  uint8_t sec;
+  uint8_t ms100;
+});
+
+static uint8_t logsBuffers[2][LOGS_BUFFER_SIZE] __DMA;
+static uint8_t logsCurrentBuffer;
+static uint16_t logsBufferCount;       // bytes in the current buffer
+static uint16_t logsChunkSize;         // the first chunk is shorter to end on a sector boundary
+static uint16_t logsPendingCount;      // bytes of the other buffer waiting to be written
+static FRESULT logsResult;
+static bool logsDescribing;
+#if defined(TELEMETRY_FRSKY)
+static uint8_t logsSensorFields[MAX_TELEMETRY_SENSORS]; // field type and prec of each logged sensor, 0 if not logged
+#endif
+
+static void logsResetBuffers()
+{
+  logsCurrentBuffer = 0;
+  logsBufferCount = 0;
+  logsPendingCount = 0;
+  logsChunkSize = LOGS_BUFFER_SIZE - (f_size(&g_oLogFile) % LOGS_BUFFER_SIZE);
+  logsResult = FR_OK;
+}
+
+static void logsWriteBuffer(const uint8_t * buffer, uint16_t count)
+{
+  if (count > 0 && logsResult == FR_OK) {
+    UINT written;
+    logsResult = f_write(&g_oLogFile, buffer, count, &written);
+    if (logsResult == FR_OK && written != count) {
+      logsResult = FR_DENIED; // SD card full
+    }
+  }
+}
+
+static void logsFlushPending()
+{
+  logsWriteBuffer(logsBuffers[1 - logsCurrentBuffer], logsPendingCount);
+  logsPendingCount = 0;
+}
+
+static void logsFlush()
+{
+  logsFlushPending();
+  logsWriteBuffer(logsBuffers[logsCurrentBuffer], logsBufferCount);
+  logsBufferCount = 0;
+}
+
+static void logsPut(const void * data, uint16_t size)
+{
+  const uint8_t * ptr = (const uint8_t *)data;
+  while (size > 0) {
+    uint16_t count = min<uint16_t>(size, logsChunkSize - logsBufferCount);
+    memcpy(&logsBuffers[logsCurrentBuffer][logsBufferCount], ptr, count);
+    logsBufferCount += count;
+    ptr += count;
+    size -= count;
+    if (logsBufferCount == logsChunkSize) {
+      // the SD card is too slow, the other buffer has to be written now
+      logsFlushPending();
+      logsPendingCount = logsBufferCount;
+      logsCurrentBuffer = 1 - logsCurrentBuffer;
+      logsBufferCount = 0;
+      logsChunkSize = LOGS_BUFFER_SIZE;
+    }
+  }
+}
+
+static void logsPuts(const char * s)
+{
+  logsPut(s, strlen(s));
+}
+
+static void logsPutc(char c)
+{
+  logsPut(&c, 1);
+}
+
+static void logsPutRecord();
+
+#if defined(TELEMETRY_FRSKY)
+static uint8_t getLogsSensorField(int index)
+{
+  if (!isTelemetryFieldAvailable(index))
+    return 0;
+  TelemetrySensor & sensor = g_model.telemetrySensors[index];
+  if (!sensor.logs)
+    return 0;
+  if (sensor.unit == UNIT_GPS)
+    return LOG_FIELD_GPS << 4;
+  if (sensor.unit == UNIT_DATETIME)
+    return LOG_FIELD_DATETIME << 4;
+  return (LOG_FIELD_VALUE << 4) + sensor.prec;
+}
+
+// Sensors appear, get deleted or have their logging toggled while the log is open,
+// in which case the records need a new header to be decoded
+static bool logsSensorFieldsChanged()
+{
+  bool changed = false;
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    uint8_t field = getLogsSensorField(i);
+    if (field != logsSensorFields[i]) {
+      logsSensorFields[i] = field;
+      changed = true;
+    }
+  }
+  return changed;
+}
+#endif
+
+static void logsPutField(uint8_t type, uint8_t prec, const void * data, uint8_t size)
+{
+  if (logsDescribing) {
+    uint8_t field[] = { type, prec };
+    logsPut(field, sizeof(field));
+  }
+  else {
+    logsPut(data, size);
+  }
+}
+#else
+#define logsPuts(s)                    f_puts(s, &g_oLogFile)
+#define logsPutc(c)                    f_putc(c, &g_oLogFile)
+#endif
+
 #if defined(PCBTARANIS) || defined(PCBHORUS)
   #define GET_2POS_STATE(sw) (switchState(SW_ ## sw ## 0) ? -1 : 1)
 #else
@@ -104,9 +259,15 @@ const pm_char * logsOpen()
     return SDCARD_ERROR(result);
   }
 
+#if defined(LOG_BINARY)
+  // fields may have changed since the last session, each one has its own header
+  logsResetBuffers();
+  writeHeader();
+#else
   if (f_size(&g_oLogFile) == 0) {
     writeHeader();
   }
+#endif
 
   return NULL;
 }
@@ -116,6 +277,11 @@ tmr10ms_t lastLogTime = 0;
 void logsClose()
 {
   if (sdMounted()) {
+#if defined(LOG_BINARY)
+    if (g_oLogFile.obj.fs) {
+      logsFlush();
+    }
+#endif
     if (f_close(&g_oLogFile) != FR_OK) {
       // close failed, forget file
       g_oLogFile.obj.fs = 0;
@@ -134,25 +300,37 @@ getvalue_t getConvertedTelemetryValue(getvalue_t val, uint8_t unit)
 
 void writeHeader()
 {
+#if defined(LOG_BINARY)
+  static const uint8_t magic[] = { 'O', 'T', 'X', 'L', LOG_BINARY_VERSION };
+#if defined(TELEMETRY_FRSKY)
+  logsSensorFieldsChanged(); // the fields described below
+#endif
+  logsPut(magic, sizeof(magic));
+  logsDescribing = true;
+  logsPutRecord();
+  logsDescribing = false;
+  logsPutc(LOG_FIELD_END);
+#endif
+
 #if defined(RTCLOCK)
-  f_puts("Date,Time,", &g_oLogFile);
+  logsPuts("Date,Time,");
 #else
-  f_puts("Time,", &g_oLogFile);
+  logsPuts("Time,");
 #endif
 
 #if defined(TELEMETRY_FRSKY)
 #if !defined(CPUARM)
-  f_puts("Buffer,RX,TX,A1,A2,", &g_oLogFile);
+  logsPuts("Buffer,RX,TX,A1,A2,");
 #if defined(FRSKY_HUB)
   if (IS_USR_PROTO_FRSKY_HUB()) {
-    f_puts("GPS Date,GPS Time,Long,Lat,Course,GPS Speed(kts),GPS Alt,Baro Alt(", &g_oLogFile);
-    f_puts(TELEMETRY_BARO_ALT_UNIT, &g_oLogFile);
-    f_puts("),Vertical Speed,Air Speed(kts),Temp1,Temp2,RPM,Fuel," TELEMETRY_CELLS_LABEL "Current,Consumption,Vfas,AccelX,AccelY,AccelZ,", &g_oLogFile);
+    logsPuts("GPS Date,GPS Time,Long,Lat,Course,GPS Speed(kts),GPS Alt,Baro Alt(");
+    logsPuts(TELEMETRY_BARO_ALT_UNIT);
+    logsPuts("),Vertical Speed,Air Speed(kts),Temp1,Temp2,RPM,Fuel," TELEMETRY_CELLS_LABEL "Current,Consumption,Vfas,AccelX,AccelY,AccelZ,");
   }
 #endif
 #if defined(WS_HOW_HIGH)
   if (IS_USR_PROTO_WS_HOW_HIGH()) {
-    f_puts("WSHH Alt,", &g_oLogFile);
+    logsPuts("WSHH Alt,");
   }
 #endif
 #endif
@@ -173,7 +351,7 @@ void writeHeader()
           strcat(label, ")");
         }
         strcat(label, ",");
-        f_puts(label, &g_oLogFile);
+        logsPuts(label);
       }
     }
   }
@@ -185,10 +363,10 @@ void writeHeader()
     const char * p = STR_VSRCRAW + i * STR_VSRCRAW[0] + 2;
     for (uint8_t j=0; j<STR_VSRCRAW[0]-1; ++j) {
       if (!*p) break;
-      f_putc(*p, &g_oLogFile);
+      logsPutc(*p);
       ++p;
     }
-    f_putc(',', &g_oLogFile);
+    logsPutc(',');
   }
 #if defined(PCBX7)
   #define STR_SWITCHES_LOG_HEADER  "SA,SB,SC,SD,SF,SH"
@@ -197,12 +375,12 @@ void writeHeader()
 #else
   #define STR_SWITCHES_LOG_HEADER  "SA,SB,SC,SD,SE,SF,SG,SH"
 #endif
-  f_puts(STR_SWITCHES_LOG_HEADER ",LSW,", &g_oLogFile);
+  logsPuts(STR_SWITCHES_LOG_HEADER ",LSW,");
 #else
-  f_puts("Rud,Ele,Thr,Ail,P1,P2,P3,THR,RUD,ELE,3POS,AIL,GEA,TRN,", &g_oLogFile);
+  logsPuts("Rud,Ele,Thr,Ail,P1,P2,P3,THR,RUD,ELE,3POS,AIL,GEA,TRN,");
 #endif
 
-  f_puts("TxBat(V)\n", &g_oLogFile);
+  logsPuts("TxBat(V)\n");
 }
 
 uint32_t getLogicalSwitchesStates(uint8_t first)
@@ -214,6 +392,91 @@ uint32_t getLogicalSwitchesStates(uint8_t first)
   return result;
 }
 
+#if defined(RTCLOCK)
+static const struct gtm & getLogsTime()
+{
+  static struct gtm utm;
+  static gtime_t lastRtcTime = 0;
+  if (g_rtcTime != lastRtcTime) {
+    lastRtcTime = g_rtcTime;
+    gettime(&utm);
+  }
+  return utm;
+}
+#endif
+
+#if defined(LOG_BINARY)
+static void logsPutValue(int32_t value, uint8_t prec=0)
+{
+  logsPutField(LOG_FIELD_VALUE, prec, &value, sizeof(value));
+}
+
+static void logsPutSwitches(const int * positions, uint8_t count)
+{
+  for (uint8_t i=0; i<count; i++) {
+    int8_t position = positions[i];
+    logsPutField(LOG_FIELD_SWITCH, 0, &position, sizeof(position));
+  }
+}
+
+// Fields have to follow the CSV columns written by writeHeader()
+static void logsPutRecord()
+{
+#if defined(RTCLOCK)
+  const struct gtm & utm = getLogsTime();
+  LogDate date = { uint16_t(utm.tm_year+TM_YEAR_BASE), uint8_t(utm.tm_mon+1), uint8_t(utm.tm_mday), uint8_t(utm.tm_hour), uint8_t(utm.tm_min), uint8_t(utm.tm_sec), g_ms100 };
+  logsPutField(LOG_FIELD_DATE, 0, &date, sizeof(date));
+#else
+  uint32_t time = get_tmr10ms();
+  logsPutField(LOG_FIELD_TIME, 0, &time, sizeof(time));
+#endif
+
+#if defined(TELEMETRY_FRSKY)
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    if (isTelemetryFieldAvailable(i)) {
+      TelemetrySensor & sensor = g_model.telemetrySensors[i];
+      TelemetryItem & telemetryItem = telemetryItems[i];
+      if (sensor.logs) {
+        if (sensor.unit == UNIT_GPS) {
+          int32_t gps[] = { telemetryItem.gps.latitude, telemetryItem.gps.longitude };
+          logsPutField(LOG_FIELD_GPS, 0, gps, sizeof(gps));
+        }
+        else if (sensor.unit == UNIT_DATETIME) {
+          LogDate date = { telemetryItem.datetime.year, telemetryItem.datetime.month, telemetryItem.datetime.day, telemetryItem.datetime.hour, telemetryItem.datetime.min, telemetryItem.datetime.sec, 0 };
+          logsPutField(LOG_FIELD_DATETIME, 0, &date, sizeof(date));
+        }
+        else {
+          logsPutValue(telemetryItem.value, sensor.prec);
+        }
+      }
+    }
+  }
+#endif
+
+  for (uint8_t i=0; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS; i++) {
+    logsPutField(LOG_FIELD_ANALOG, 0, &calibratedAnalogs[i], sizeof(int16_t));
+  }
+
+#if defined(PCBXLITE)
+  const int positions[] = { GET_3POS_STATE(SA), GET_3POS_STATE(SB), GET_3POS_STATE(SC), GET_3POS_STATE(SD) };
+#elif defined(PCBX7)
+  const int positions[] = { GET_3POS_STATE(SA), GET_3POS_STATE(SB), GET_3POS_STATE(SC), GET_3POS_STATE(SD), GET_2POS_STATE(SF), GET_2POS_STATE(SH) };
+#elif defined(PCBTARANIS) || defined(PCBHORUS)
+  const int positions[] = { GET_3POS_STATE(SA), GET_3POS_STATE(SB), GET_3POS_STATE(SC), GET_3POS_STATE(SD), GET_3POS_STATE(SE), GET_2POS_STATE(SF), GET_3POS_STATE(SG), GET_2POS_STATE(SH) };
+#else
+  const int positions[] = { GET_2POS_STATE(THR), GET_2POS_STATE(RUD), GET_2POS_STATE(ELE), GET_3POS_STATE(ID), GET_2POS_STATE(AIL), GET_2POS_STATE(GEA), GET_2POS_STATE(TRN) };
+#endif
+  logsPutSwitches(positions, DIM(positions));
+
+#if defined(PCBTARANIS) || defined(PCBHORUS)
+  uint32_t logicalSwitches[] = { getLogicalSwitchesStates(32), getLogicalSwitchesStates(0) };
+  logsPutField(LOG_FIELD_LOGICAL_SWITCHES, 0, logicalSwitches, sizeof(logicalSwitches));
+#endif
+
+  logsPutValue(g_vbat100mV, 1);
+}
+#endif
+
 void logsWrite()
 {
   static const pm_char * error_displayed = NULL;
@@ -234,14 +497,24 @@ void logsWrite()
         }
       }
 
+#if defined(LOG_BINARY)
+#if defined(TELEMETRY_FRSKY)
+      if (logsSensorFieldsChanged()) {
+        writeHeader();
+      }
+#endif
+      logsPutc(LOG_RECORD_TAG);
+      logsPutRecord();
+
+      if (logsResult != FR_OK && !error_displayed) {
+        error_displayed = STR_SDCARD_ERROR;
+        POPUP_WARNING(STR_SDCARD_ERROR);
+        logsClose();
+      }
+#else
 #if defined(RTCLOCK)
       {
-        static struct gtm utm;
-        static gtime_t lastRtcTime = 0;
-        if (g_rtcTime != lastRtcTime) {
-          lastRtcTime = g_rtcTime;
-          gettime(&utm);
-        }
+        const struct gtm & utm = getLogsTime();
         f_printf(&g_oLogFile, "%4d-%02d-%02d,%02d:%02d:%02d.%02d0,", utm.tm_year+TM_YEAR_BASE, utm.tm_mon+1, utm.tm_mday, utm.tm_hour, utm.tm_min, utm.tm_sec, g_ms100);
       }
 #else
@@ -396,7 +669,14 @@ void logsWrite()
         POPUP_WARNING(STR_SDCARD_ERROR);
         logsClose();
       }
+#endif
+    }
+#if defined(LOG_BINARY)
+    else if (logsPendingCount > 0) {
+      // write the full buffer between two records
+      logsFlushPending();
     }
+#endif
   }
   else {
     error_displayed = NULL;
@@ -45,7 +45,6 @@
   #define RADIO_VERSION FLAVOUR
 #endif
 
-#define FIND_FIELD_DESC  0x01
 
 /*luadoc
 @function getVersion()
@@ -264,46 +263,159 @@ void luaGetValueAndPush(lua_State* L, int src)
   }
 }
 
+static const LuaSingleField * luaFindSingleField(const char * name)
+{
+  // luaSingleFields[] is sorted by name
+  int lo = 0, hi = DIM(luaSingleFields) - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+    int cmp = strcmp(name, luaSingleFields[mid].name);
+    if (cmp == 0)
+      return &luaSingleFields[mid];
+    else if (cmp < 0)
+      hi = mid - 1;
+    else
+      lo = mid + 1;
+  }
+  return NULL;
+}
+
+static const LuaMultipleField * luaFindMultipleField(const char * name, unsigned int len)
+{
+  // luaMultipleFields[] is sorted by name, and no name ends with a digit
+  int lo = 0, hi = DIM(luaMultipleFields) - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+    const char * fieldName = luaMultipleFields[mid].name;
+    int cmp = strncmp(name, fieldName, len);
+    if (cmp == 0 && fieldName[len] != '\0')
+      cmp = -1;
+    if (cmp == 0)
+      return &luaMultipleFields[mid];
+    else if (cmp < 0)
+      hi = mid - 1;
+    else
+      lo = mid + 1;
+  }
+  return NULL;
+}
+
+// Telemetry scripts ask for the same few sensor names on each run, the
+// sensor found for a name (or its absence) is kept until the sensors change.
+// The cache is 2-way set associative, the most recent entry first
+#define LUA_SENSOR_NAMES_CACHE_SETS    8
+#define LUA_SENSOR_NAME_LEN            (TELEM_LABEL_LEN+1) // with the '-' or '+' suffix
+
+struct LuaSensorNameCacheEntry {
+  uint32_t version;
+  uint16_t id;       // 0 when the sensor doesn't exist
+  char name[LUA_SENSOR_NAME_LEN+1];
+};
+
+static LuaSensorNameCacheEntry luaSensorNamesCache[LUA_SENSOR_NAMES_CACHE_SETS][2];
+LuaSensorNamesCacheStats luaSensorNamesCacheStats;
+
+static int luaMatchSensorName(int index, const char * name)
+{
+  char sensorName[TELEM_LABEL_LEN+1];
+  int len = zchar2str(sensorName, g_model.telemetrySensors[index].label, TELEM_LABEL_LEN);
+  if (!strncmp(sensorName, name, len)) {
+    if (name[len] == '\0')
+      return MIXSRC_FIRST_TELEM + 3*index;
+    else if (name[len] == '-' && name[len+1] == '\0')
+      return MIXSRC_FIRST_TELEM + 3*index + 1;
+    else if (name[len] == '+' && name[len+1] == '\0')
+      return MIXSRC_FIRST_TELEM + 3*index + 2;
+  }
+  return 0;
+}
+
+static int luaFindSensorByName(const char * name, unsigned int len)
+{
+  if (len > LUA_SENSOR_NAME_LEN) {
+    return 0;
+  }
+
+  uint32_t version = telemetrySensorsVersion;
+  uint32_t hash = 2166136261u;
+  for (unsigned int i=0; i<len; i++) {
+    hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+  }
+
+  LuaSensorNameCacheEntry * set = luaSensorNamesCache[(hash ^ (hash >> 16)) % LUA_SENSOR_NAMES_CACHE_SETS];
+  for (int way=0; way<2; way++) {
+    LuaSensorNameCacheEntry & entry = set[way];
+    if (entry.version == version && !strcmp(entry.name, name)) {
+      // the sensor label may have been edited in place, it is checked again
+      if (entry.id == 0 || luaMatchSensorName((entry.id - MIXSRC_FIRST_TELEM) / 3, name) == entry.id) {
+        int id = entry.id;
+        if (way == 1) {
+          LuaSensorNameCacheEntry tmp = set[0];
+          set[0] = set[1];
+          set[1] = tmp;
+        }
+        luaSensorNamesCacheStats.hits++;
+        return id;
+      }
+    }
+  }
+
+  luaSensorNamesCacheStats.misses++;
+
+  int id = 0;
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    if (isTelemetryFieldAvailable(i)) {
+      id = luaMatchSensorName(i, name);
+      if (id) {
+        break;
+      }
+    }
+  }
+
+  set[1] = set[0];
+  set[0].version = version;
+  set[0].id = id;
+  strcpy(set[0].name, name);
+
+  return id;
+}
+
 /**
   Return field data for a given field name
 */
 bool luaFindFieldByName(const char * name, LuaField & field, unsigned int flags)
 {
-  // TODO better search method (binary lookup)
-  for (unsigned int n=0; n<DIM(luaSingleFields); ++n) {
-    if (!strcmp(name, luaSingleFields[n].name)) {
-      field.id = luaSingleFields[n].id;
-      if (flags & FIND_FIELD_DESC) {
-        strncpy(field.desc, luaSingleFields[n].desc, sizeof(field.desc)-1);
-        field.desc[sizeof(field.desc)-1] = '\0';
-      }
-      else {
-        field.desc[0] = '\0';
-      }
-      return true;
+  const LuaSingleField * single = luaFindSingleField(name);
+  if (single) {
+    field.id = single->id;
+    if (flags & FIND_FIELD_DESC) {
+      strncpy(field.desc, single->desc, sizeof(field.desc)-1);
+      field.desc[sizeof(field.desc)-1] = '\0';
     }
+    else {
+      field.desc[0] = '\0';
+    }
+    return true;
   }
 
-  // search in multiples
+  // search in multiples, the index is made of 1 or 2 digits at the end of the name
   unsigned int len = strlen(name);
-  for (unsigned int n=0; n<DIM(luaMultipleFields); ++n) {
-    const char * fieldName = luaMultipleFields[n].name;
-    unsigned int fieldLen = strlen(fieldName);
-    if (!strncmp(name, fieldName, fieldLen)) {
+  unsigned int fieldLen = len;
+  while (fieldLen > 0 && isdigit(name[fieldLen-1])) {
+    fieldLen--;
+  }
+  if (fieldLen > 0 && len > fieldLen && len <= fieldLen+2) {
+    const LuaMultipleField * multiple = luaFindMultipleField(name, fieldLen);
+    if (multiple) {
       unsigned int index;
-      if (len == fieldLen+1 && isdigit(name[fieldLen])) {
+      if (len == fieldLen+1)
         index = name[fieldLen] - '1';
-      }
-      else if (len == fieldLen+2 && isdigit(name[fieldLen]) && isdigit(name[fieldLen+1])) {
+      else
         index = 10 * (name[fieldLen] - '0') + (name[fieldLen+1] - '1');
-      }
-      else {
-        continue;
-      }
-      if (index < luaMultipleFields[n].count) {
-        field.id = luaMultipleFields[n].id + index;
+      if (index < multiple->count) {
+        field.id = multiple->id + index;
         if (flags & FIND_FIELD_DESC) {
-          snprintf(field.desc, sizeof(field.desc)-1, luaMultipleFields[n].desc, index+1);
+          snprintf(field.desc, sizeof(field.desc)-1, multiple->desc, index+1);
           field.desc[sizeof(field.desc)-1] = '\0';
         }
         else {
@@ -316,28 +428,10 @@ bool luaFindFieldByName(const char * name, LuaField & field, unsigned int flags)
 
   // search in telemetry
   field.desc[0] = '\0';
-  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
-    if (isTelemetryFieldAvailable(i)) {
-      char sensorName[TELEM_LABEL_LEN+1];
-      int len = zchar2str(sensorName, g_model.telemetrySensors[i].label, TELEM_LABEL_LEN);
-      if (!strncmp(sensorName, name, len)) {
-        if (name[len] == '\0') {
-          field.id = MIXSRC_FIRST_TELEM + 3*i;
-          field.desc[0] = '\0';
-          return true;
-        }
-        else if (name[len] == '-' && name[len+1] == '\0') {
-          field.id = MIXSRC_FIRST_TELEM + 3*i + 1;
-          field.desc[0] = '\0';
-          return true;
-        }
-        else if (name[len] == '+' && name[len+1] == '\0') {
-          field.id = MIXSRC_FIRST_TELEM + 3*i + 2;
-          field.desc[0] = '\0';
-          return true;
-        }
-      }
-    }
+  int id = luaFindSensorByName(name, len);
+  if (id) {
+    field.id = id;
+    return true;
   }
 
   return false;  // not found
@@ -590,6 +684,7 @@ or a name (string) of the source.
  * non-existing sources
  * for all telemetry source when the telemetry stream is not received
  * far all non allowed sensors while FAI MODE is active
+ * channels (`ch1`, `ch2`, ...) without any mixer line
 
 @retval table GPS position is returned in a table:
  * `lat` (number) latitude, positive is North
@@ -645,6 +645,7 @@ static int luaModelInsertMix(lua_State *L)
         mix->speedDown = luaL_checkinteger(L, -1);
       }
     }
+    storageDirty(EE_MODEL);
   }
 
   return 0;
@@ -681,11 +682,15 @@ static int luaModelDeleteMix(lua_State *L)
 
 Remove all mixers
 
+@notice From the next mixer cycle on, getValue() returns 0 for all channels (`ch1`, `ch2`, ...),
+as for any channel without mixer line.
+
 @status current Introduced in 2.0.0
 */
 static int luaModelDeleteMixes(lua_State *L)
 {
   memset(g_model.mixData, 0, sizeof(g_model.mixData));
+  storageDirty(EE_MODEL);
   return 0;
 }
 
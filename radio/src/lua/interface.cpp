@@ -353,20 +353,221 @@ static int luaDumpWriter(lua_State * L, const void* p, size_t size, void* u)
     1 = remove debug info from bytecode (smaller but errors are less informative)
     0 = keep debug info
 */
-static void luaDumpState(lua_State * L, const char * filename, const FILINFO * finfo, int stripDebug)
+static bool luaDumpState(lua_State * L, const char * filename, const FILINFO * finfo, int stripDebug)
 {
   FIL D;
   if (f_open(&D, filename, FA_WRITE | FA_CREATE_ALWAYS) == FR_OK) {
     lua_lock(L);
-    luaU_dump(L, getproto(L->top - 1), luaDumpWriter, &D, stripDebug);
+    int result = luaU_dump(L, getproto(L->top - 1), luaDumpWriter, &D, stripDebug);
     lua_unlock(L);
-    if (f_close(&D) == FR_OK) {
+    if (f_close(&D) == FR_OK && result == 0) {
       if (finfo != NULL)
         f_utime(filename, finfo);  // set the file mod time
       TRACE("luaDumpState(%s): Saved bytecode to file.", filename);
+      return true;
     }
   } else
     TRACE_ERROR("luaDumpState(%s): Error: Could not open output file.", filename);
+  return false;
+}
+
+/*
+  Bytecode cache
+
+  Scripts loaded with the default "bt" mode are compiled once into SCRIPTS_CACHE_PATH,
+  whatever the model using them. The index of the cache is read in one go on first use,
+  each entry is keyed on the source path hash, size and date, and the whole index on
+  the Lua bytecode format of the firmware, so that a firmware update invalidates it.
+  A script load then costs one f_stat() of the source before loading its bytecode.
+*/
+
+#define LUA_CACHE_MAGIC           0x4341554C // "LUAC"
+#define LUA_CACHE_MAX_ENTRIES     48
+
+PACK(struct LuaCacheEntry {
+  uint32_t pathHash;
+  uint32_t size;      // of the source
+  uint32_t datetime;  // of the source
+  uint32_t lastUse;
+});
+
+PACK(struct LuaCacheIndex {
+  uint32_t magic;
+  uint32_t abi;
+  uint32_t checksum;
+  uint16_t count;
+  uint16_t spare;
+  LuaCacheEntry entries[LUA_CACHE_MAX_ENTRIES];
+});
+
+static LuaCacheIndex luaCacheIndex;
+static bool luaCacheLoaded = false;
+static uint32_t luaCacheUseCounter;
+LuaCacheStats luaCacheStats;
+
+void luaCacheReset()
+{
+  // the index will be read again on next script load
+  luaCacheLoaded = false;
+}
+
+static uint32_t luaCacheHash(uint32_t hash, const void * data, uint32_t size)
+{
+  for (uint32_t i=0; i<size; i++) {
+    hash = (hash ^ ((const uint8_t *)data)[i]) * 16777619u;
+  }
+  return hash;
+}
+
+static uint32_t luaCacheAbi()
+{
+  lu_byte header[LUAC_HEADERSIZE];
+  luaU_header(header);
+  return luaCacheHash(2166136261u, header, sizeof(header));
+}
+
+static uint32_t luaCacheChecksum()
+{
+  return luaCacheHash(2166136261u, luaCacheIndex.entries, luaCacheIndex.count * sizeof(LuaCacheEntry));
+}
+
+static void luaCacheLoadIndex()
+{
+  FIL file;
+  UINT read = 0;
+
+  luaCacheLoaded = true;
+  luaCacheUseCounter = 0;
+
+  if (f_open(&file, SCRIPTS_CACHE_INDEX, FA_OPEN_EXISTING | FA_READ) == FR_OK) {
+    f_read(&file, &luaCacheIndex, sizeof(luaCacheIndex), &read);
+    f_close(&file);
+  }
+
+  if (read < sizeof(luaCacheIndex) - sizeof(luaCacheIndex.entries) ||
+      luaCacheIndex.magic != LUA_CACHE_MAGIC ||
+      luaCacheIndex.abi != luaCacheAbi() ||
+      luaCacheIndex.count > LUA_CACHE_MAX_ENTRIES ||
+      read < sizeof(luaCacheIndex) - sizeof(luaCacheIndex.entries) + luaCacheIndex.count * sizeof(LuaCacheEntry) ||
+      luaCacheIndex.checksum != luaCacheChecksum()) {
+    TRACE("luaCacheLoadIndex(): no valid index");
+    memclear(&luaCacheIndex, sizeof(luaCacheIndex));
+    luaCacheIndex.magic = LUA_CACHE_MAGIC;
+    luaCacheIndex.abi = luaCacheAbi();
+    return;
+  }
+
+  for (int i=0; i<luaCacheIndex.count; i++) {
+    luaCacheUseCounter = max(luaCacheUseCounter, luaCacheIndex.entries[i].lastUse);
+  }
+}
+
+static void luaCacheSaveIndex()
+{
+  FIL file;
+  UINT written;
+
+  luaCacheIndex.checksum = luaCacheChecksum();
+  if (f_open(&file, SCRIPTS_CACHE_INDEX, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK) {
+    f_write(&file, &luaCacheIndex, sizeof(luaCacheIndex) - sizeof(luaCacheIndex.entries) + luaCacheIndex.count * sizeof(LuaCacheEntry), &written);
+    f_close(&file);
+  }
+}
+
+static void luaCacheGetFilename(char * filename, uint32_t pathHash)
+{
+  strcpy(filename, SCRIPTS_CACHE_PATH "/");
+  char * s = filename + sizeof(SCRIPTS_CACHE_PATH);
+  for (int i=28; i>=0; i-=4) {
+    *s++ = "0123456789ABCDEF"[(pathHash >> i) & 0x0F];
+  }
+  strcpy(s, SCRIPT_BIN_EXT);
+}
+
+static LuaCacheEntry * luaCacheFindEntry(uint32_t pathHash)
+{
+  for (int i=0; i<luaCacheIndex.count; i++) {
+    if (luaCacheIndex.entries[i].pathHash == pathHash) {
+      return &luaCacheIndex.entries[i];
+    }
+  }
+  return NULL;
+}
+
+static void luaCacheRemoveEntry(LuaCacheEntry * entry)
+{
+  *entry = luaCacheIndex.entries[--luaCacheIndex.count];
+}
+
+static LuaCacheEntry * luaCacheNewEntry(uint32_t pathHash)
+{
+  if (luaCacheIndex.count == LUA_CACHE_MAX_ENTRIES) {
+    // the least recently used entry is replaced
+    LuaCacheEntry * oldest = &luaCacheIndex.entries[0];
+    for (int i=1; i<luaCacheIndex.count; i++) {
+      if (luaCacheIndex.entries[i].lastUse < oldest->lastUse) {
+        oldest = &luaCacheIndex.entries[i];
+      }
+    }
+    char filename[sizeof(SCRIPTS_CACHE_PATH) + 8 + sizeof(SCRIPT_BIN_EXT)];
+    luaCacheGetFilename(filename, oldest->pathHash);
+    f_unlink(filename);
+    luaCacheRemoveEntry(oldest);
+  }
+  LuaCacheEntry * entry = &luaCacheIndex.entries[luaCacheIndex.count++];
+  entry->pathHash = pathHash;
+  return entry;
+}
+
+/*
+  Load a Lua source file through the bytecode cache, compiling it when needed. Returns the Lua status.
+*/
+static int luaLoadCachedScript(lua_State * L, const char * filename, const FILINFO * finfo)
+{
+  char cacheFilename[sizeof(SCRIPTS_CACHE_PATH) + 8 + sizeof(SCRIPT_BIN_EXT)];
+  uint32_t pathHash = 2166136261u;
+  for (const char * s = filename; *s; s++) {
+    char c = toupper(*s);  // FAT file names are case insensitive
+    pathHash = luaCacheHash(pathHash, &c, 1);
+  }
+  uint32_t datetime = ((uint32_t)finfo->fdate << 16) + finfo->ftime;
+
+  if (!luaCacheLoaded) {
+    luaCacheLoadIndex();
+  }
+
+  luaCacheGetFilename(cacheFilename, pathHash);
+
+  LuaCacheEntry * entry = luaCacheFindEntry(pathHash);
+  if (entry) {
+    if (entry->size == finfo->fsize && entry->datetime == datetime) {
+      int lstatus = luaL_loadfilex(L, cacheFilename, "b");
+      if (lstatus == LUA_OK) {
+        entry->lastUse = ++luaCacheUseCounter;
+        luaCacheStats.hits++;
+        return LUA_OK;
+      }
+      // broken or missing bytecode file
+      TRACE_ERROR("luaLoadCachedScript(%s): %s", cacheFilename, lua_tostring(L, -1));
+      lua_pop(L, 1);
+    }
+    luaCacheRemoveEntry(entry);
+  }
+
+  luaCacheStats.misses++;
+
+  int lstatus = luaL_loadfilex(L, filename, NULL);
+  if (lstatus == LUA_OK) {
+    f_mkdir(SCRIPTS_CACHE_PATH);
+    if (luaDumpState(L, cacheFilename, NULL, 1)) {
+      entry = luaCacheNewEntry(pathHash);
+      entry->size = finfo->fsize;
+      entry->datetime = datetime;
+      entry->lastUse = ++luaCacheUseCounter;
+    }
+    luaCacheSaveIndex();
+  }
+  return lstatus;
 }
 #endif  // LUA_COMPILER
 
@@ -386,6 +587,7 @@ static void luaDumpState(lua_State * L, const char * filename, const FILINFO * f
     "t" only text.
     "T" (default on simulator) prefer text but load binary if that is the only version available.
     "bt" (default on radio) either binary or text, whichever is newer (binary preferred when timestamps are equal).
+      When the text version exists, it is compiled into the bytecode cache (SCRIPTS_CACHE_PATH) instead.
     Add "x" to avoid automatic compilation of source file to .luac version.
       Eg: "tx", "bx", or "btx".
     Add "c" to force compilation of source file to .luac version (even if existing version is newer than source file).
@@ -439,14 +641,23 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
   }
   strncat(filenameFull, filename, fnamelen);
 
-  // check if binary version exists
-  strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
-  frLuaC = f_stat(filenameFull, &fnoLuaC);
-
   // check if text version exists
   strcpy(filenameFull + fnamelen, SCRIPT_EXT);
   frLuaS = f_stat(filenameFull, &fnoLuaS);
 
+  // in the default mode, sources are compiled in the bytecode cache instead of next to them
+  bool loadThroughCache = (frLuaS == FR_OK && strchr(lmode, 'b') && strchr(lmode, 't') && !strpbrk(lmode, "cdx"));
+
+  // check if binary version exists
+  if (loadThroughCache) {
+    frLuaC = FR_NO_FILE;
+  }
+  else {
+    strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
+    frLuaC = f_stat(filenameFull, &fnoLuaC);
+    strcpy(filenameFull + fnamelen, SCRIPT_EXT);
+  }
+
   // decide which version to load, text or binary
   if (frLuaC != FR_OK && frLuaS == FR_OK) {
     // only text version exists
@@ -505,6 +716,15 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
 
   TRACE("luaLoadScriptFileToState(%s, %s): loading %s", filename, lmode, filenameFull);
 
+#if defined(DISK_CACHE)
+  diskCache.setClient(DISK_CACHE_CLIENT_LUA);
+#endif
+
+#if defined(LUA_COMPILER)
+  if (loadThroughCache)
+    lstatus = luaLoadCachedScript(L, filenameFull, &fnoLuaS);
+  else
+#endif
   // we don't pass <mode> on to loadfilex() because we want lua to load whatever file we specify, regardless of content
   lstatus = luaL_loadfilex(L, filenameFull, NULL);
 #if defined(LUA_COMPILER)
@@ -517,7 +737,7 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
     lstatus = luaL_loadfilex(L, filenameFull, NULL);
   }
   if (lstatus == LUA_OK) {
-    if (scriptNeedsCompile && loadFileType == 1) {
+    if (scriptNeedsCompile && loadFileType == 1 && !loadThroughCache) {
       strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
       luaDumpState(L, filenameFull, &fnoLuaS, (strchr(lmode, 'd') ? 0 : 1));
     }
@@ -539,6 +759,10 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
     }
   }
 
+#if defined(DISK_CACHE)
+  diskCache.setClient(DISK_CACHE_CLIENT_OTHER);
+#endif
+
   return ret;
 }
 
@@ -994,6 +1218,7 @@ bool luaDoOneRunPermanentScript(event_t evt, int i, uint32_t scriptType)
 
 bool luaTask(event_t evt, uint8_t scriptType, bool allowLcdUsage)
 {
+  ProfilerTaskScope scope(PROFILER_TASK_LUA);
   if (luaState == INTERPRETER_PANIC) return false;
   luaLcdAllowed = allowLcdUsage;
   bool scriptWasRun = false;
@@ -1051,6 +1276,10 @@ void checkLuaMemoryUsage()
 #endif
   if (totalMemUsed > LUA_MEM_MAX) {
     TRACE("checkLuaMemoryUsage(): max limit reached (%u), killing Lua", totalMemUsed);
+#if defined(USE_BIN_ALLOCATOR)
+    TRACE("checkLuaMemoryUsage(): bins %u/%u (peak %u), %u/%u (peak %u), %u heap fallbacks",
+          slots1.size(), slots1.capacity(), slots1.peak(), slots2.size(), slots2.capacity(), slots2.peak(), binHeapFallbacks);
+#endif
     // disable Lua scripts
     luaClose(&lsScripts);
     luaDisable();
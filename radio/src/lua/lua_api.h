@@ -166,12 +166,26 @@ struct LuaField {
   uint16_t id;
   char desc[50];
 };
+#define FIND_FIELD_DESC  0x01
 bool luaFindFieldByName(const char * name, LuaField & field, unsigned int flags=0);
+struct LuaSensorNamesCacheStats {
+  uint32_t hits;
+  uint32_t misses;
+};
+extern LuaSensorNamesCacheStats luaSensorNamesCacheStats;
 void luaLoadThemes();
 void luaRegisterLibraries(lua_State * L);
 void registerBitmapClass(lua_State * L);
 void luaSetInstructionsLimit(lua_State* L, int count);
 int luaLoadScriptFileToState(lua_State * L, const char * filename, const char * mode);
+#if defined(LUA_COMPILER)
+struct LuaCacheStats {
+  uint32_t hits;
+  uint32_t misses;
+};
+extern LuaCacheStats luaCacheStats;
+void luaCacheReset();
+#endif
 
 struct LuaMemTracer {
   const char * script;
@@ -330,38 +330,228 @@ int16_t applyLimits(uint8_t channel, int32_t value)
 
 // TODO same naming convention than the drawSource
 
-getvalue_t getValue(mixsrc_t i)
+#if defined(CPUARM)
+// getValue() dispatch table: each sources class is an entry with its last
+// source index, its first source index, and the accessor which receives the
+// index inside the class. The table is sorted on the last source index and
+// getValue() finds the class with a binary search.
+
+typedef getvalue_t (*SourceGetter)(unsigned idx);
+
+struct SourceClass {
+  mixsrc_t last;
+  mixsrc_t first;
+  SourceGetter get;
+};
+
+static getvalue_t getNoneValue(unsigned idx)
 {
-  if (i == MIXSRC_NONE) {
-    return 0;
-  }
+  return 0;
+}
 
 #if defined(VIRTUAL_INPUTS)
-  else if (i <= MIXSRC_LAST_INPUT) {
-    return anas[i-MIXSRC_FIRST_INPUT];
-  }
+static getvalue_t getInputValue(unsigned idx)
+{
+  return anas[idx];
+}
 #endif
 
 #if defined(LUA_INPUTS)
-  else if (i < MIXSRC_LAST_LUA) {
+static getvalue_t getLuaValue(unsigned idx)
+{
 #if defined(LUA_MODEL_SCRIPTS)
-    div_t qr = div(i-MIXSRC_FIRST_LUA, MAX_SCRIPT_OUTPUTS);
-    return scriptInputsOutputs[qr.quot].outputs[qr.rem].value;
+  return scriptInputsOutputs[idx / MAX_SCRIPT_OUTPUTS].outputs[idx % MAX_SCRIPT_OUTPUTS].value;
 #else
+  return 0;
+#endif
+}
+#endif
+
+static getvalue_t getCalibratedAnalogValue(unsigned idx)
+{
+  return calibratedAnalogs[idx];
+}
+
+#if defined(ROTARY_ENCODERS)
+static getvalue_t getRotaryEncoderValue(unsigned idx)
+{
+  return getRotaryEncoder(idx);
+}
+#endif
+
+static getvalue_t getMaxValue(unsigned idx)
+{
+  return 1024;
+}
+
+static getvalue_t getHeliValue(unsigned idx)
+{
+#if defined(HELI)
+  return cyc_anas[idx];
+#else
+  return 0;
+#endif
+}
+
+static getvalue_t getTrimSourceValue(unsigned idx)
+{
+  return calc1000toRESX((int16_t)8 * getTrimValue(mixerCurrentFlightMode, idx));
+}
+
+#if defined(PCBTARANIS) || defined(PCBHORUS)
+static getvalue_t getSwitchValue(unsigned idx)
+{
+  if (SWITCH_EXISTS(idx)) {
+    return (switchState(3*idx) ? -1024 : (switchState(3*idx+1) ? 0 : 1024));
+  }
+  else {
     return 0;
+  }
+}
+#else
+static getvalue_t getSwitchValue(unsigned idx)
+{
+  if (idx == MIXSRC_3POS - MIXSRC_FIRST_SWITCH) {
+    return (getSwitch(SW_ID0+1) ? -1024 : (getSwitch(SW_ID1+1) ? 0 : 1024));
+  }
+  // don't use switchState directly to give getSwitch possibility to hack values if needed for switch warning
+  return getSwitch(SWSRC_THR+idx-(MIXSRC_THR-MIXSRC_FIRST_SWITCH)) ? 1024 : -1024;
+}
 #endif
+
+static getvalue_t getLogicalSwitchValue(unsigned idx)
+{
+  return getSwitch(SWSRC_FIRST_LOGICAL_SWITCH+idx) ? 1024 : -1024;
+}
+
+static getvalue_t getTrainerValue(unsigned idx)
+{
+  int16_t x = ppmInput[idx];
+  if (idx < NUM_CAL_PPM) {
+    x -= g_eeGeneral.trainer.calib[idx];
   }
+  return x*2;
+}
+
+static getvalue_t getChannelValue(unsigned idx)
+{
+  return ex_chans[idx];
+}
+
+#if defined(GVARS)
+static getvalue_t getGVarSourceValue(unsigned idx)
+{
+  return GVAR_VALUE(idx, getGVarFlightMode(mixerCurrentFlightMode, idx));
+}
+#endif
+
+static getvalue_t getTxVoltageValue(unsigned idx)
+{
+  return g_vbat100mV;
+}
+
+static getvalue_t getTxTimeValue(unsigned idx)
+{
+  // TX_TIME + SPARES, the spares return the TX time as well
+#if defined(RTCLOCK)
+  return (g_rtcTime % SECS_PER_DAY) / 60; // number of minutes from midnight
+#else
+  return 0;
 #endif
+}
+
+static getvalue_t getTimerValue(unsigned idx)
+{
+  return timersStates[idx].val;
+}
+
+static getvalue_t getTelemetryValue(unsigned idx)
+{
+  if (IS_FAI_FORBIDDEN(MIXSRC_FIRST_TELEM+idx)) {
+    return 0;
+  }
+  TelemetryItem & telemetryItem = telemetryItems[idx / 3];
+  switch (idx % 3) {
+    case 1:
+      return telemetryItem.valueMin;
+    case 2:
+      return telemetryItem.valueMax;
+    default:
+      return telemetryItem.value;
+  }
+}
 
+static constexpr SourceClass sourceClasses[] = {
+  { MIXSRC_NONE, MIXSRC_NONE, getNoneValue },
+#if defined(VIRTUAL_INPUTS)
+  { MIXSRC_LAST_INPUT, MIXSRC_FIRST_INPUT, getInputValue },
+#endif
 #if defined(LUA_INPUTS)
-  else if (i <= MIXSRC_LAST_POT+NUM_MOUSE_ANALOGS) {
-    return calibratedAnalogs[i-MIXSRC_Rud];
+  { MIXSRC_LAST_LUA, MIXSRC_FIRST_LUA, getLuaValue },
+#endif
+  { MIXSRC_LAST_POT+NUM_MOUSE_ANALOGS, MIXSRC_Rud, getCalibratedAnalogValue },
+#if defined(ROTARY_ENCODERS)
+  { MIXSRC_LAST_ROTARY_ENCODER, MIXSRC_REa, getRotaryEncoderValue },
+#endif
+  { MIXSRC_MAX, MIXSRC_MAX, getMaxValue },
+  { MIXSRC_CYC3, MIXSRC_CYC1, getHeliValue },
+  { MIXSRC_LAST_TRIM, MIXSRC_FIRST_TRIM, getTrimSourceValue },
+  { MIXSRC_LAST_SWITCH, MIXSRC_FIRST_SWITCH, getSwitchValue },
+  { MIXSRC_LAST_LOGICAL_SWITCH, MIXSRC_FIRST_LOGICAL_SWITCH, getLogicalSwitchValue },
+  { MIXSRC_LAST_TRAINER, MIXSRC_FIRST_TRAINER, getTrainerValue },
+  { MIXSRC_LAST_CH, MIXSRC_CH1, getChannelValue },
+#if defined(GVARS)
+  { MIXSRC_LAST_GVAR, MIXSRC_GVAR1, getGVarSourceValue },
+#endif
+  { MIXSRC_TX_VOLTAGE, MIXSRC_TX_VOLTAGE, getTxVoltageValue },
+  { MIXSRC_FIRST_TIMER-1, MIXSRC_TX_TIME, getTxTimeValue },
+  { MIXSRC_LAST_TIMER, MIXSRC_FIRST_TIMER, getTimerValue },
+  { MIXSRC_LAST_TELEM, MIXSRC_FIRST_TELEM, getTelemetryValue },
+};
+
+#define SOURCE_CLASSES_COUNT   DIM(sourceClasses)
+
+static constexpr bool isSourceClassesTableValid(unsigned index)
+{
+  return index+1 >= SOURCE_CLASSES_COUNT || (sourceClasses[index].last < sourceClasses[index+1].first && sourceClasses[index+1].first <= sourceClasses[index+1].last && isSourceClassesTableValid(index+1));
+}
+
+static_assert(isSourceClassesTableValid(0), "getValue() sources table must be sorted");
+
+getvalue_t getValue(mixsrc_t i)
+{
+  uint8_t lo = 0;
+  uint8_t hi = SOURCE_CLASSES_COUNT - 1;
+
+  if (i > sourceClasses[hi].last) {
+    return 0;
   }
+
+  while (lo < hi) {
+    uint8_t mid = (lo + hi) / 2;
+    if (i > sourceClasses[mid].last)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  const SourceClass & sourceClass = sourceClasses[lo];
+  if (i < sourceClass.first) {
+    return 0;
+  }
+
+  return sourceClass.get(i - sourceClass.first);
+}
 #else
+getvalue_t getValue(mixsrc_t i)
+{
+  if (i == MIXSRC_NONE) {
+    return 0;
+  }
+
   else if (i>=MIXSRC_FIRST_STICK && i<=MIXSRC_LAST_POT+NUM_MOUSE_ANALOGS) {
     return calibratedAnalogs[i-MIXSRC_Rud];
   }
-#endif
 
 #if defined(PCBGRUVIN9X) || defined(PCBMEGA2560) || defined(ROTARY_ENCODERS)
   else if (i <= MIXSRC_LAST_ROTARY_ENCODER) {
@@ -385,17 +575,6 @@ getvalue_t getValue(mixsrc_t i)
     return calc1000toRESX((int16_t)8 * getTrimValue(mixerCurrentFlightMode, i-MIXSRC_FIRST_TRIM));
   }
 
-#if defined(PCBTARANIS) || defined(PCBHORUS)
-  else if ((i >= MIXSRC_FIRST_SWITCH) && (i <= MIXSRC_LAST_SWITCH)) {
-    mixsrc_t sw = i-MIXSRC_FIRST_SWITCH;
-    if (SWITCH_EXISTS(sw)) {
-      return (switchState(3*sw) ? -1024 : (switchState(3*sw+1) ? 0 : 1024));
-    }
-    else {
-      return 0;
-    }
-  }
-#else
   else if (i == MIXSRC_3POS) {
     return (getSwitch(SW_ID0+1) ? -1024 : (getSwitch(SW_ID1+1) ? 0 : 1024));
   }
@@ -403,7 +582,6 @@ getvalue_t getValue(mixsrc_t i)
   else if (i < MIXSRC_SW1) {
     return getSwitch(SWSRC_THR+i-MIXSRC_THR) ? 1024 : -1024;
   }
-#endif
 
   else if (i <= MIXSRC_LAST_LOGICAL_SWITCH) {
     return getSwitch(SWSRC_FIRST_LOGICAL_SWITCH+i-MIXSRC_FIRST_LOGICAL_SWITCH) ? 1024 : -1024;
@@ -425,48 +603,14 @@ getvalue_t getValue(mixsrc_t i)
   }
 #endif
 
-#if defined(CPUARM)
-  else if (i == MIXSRC_TX_VOLTAGE) {
-    return g_vbat100mV;
-  }
-  else if (i < MIXSRC_FIRST_TIMER) {
-    // TX_TIME + SPARES
-#if defined(RTCLOCK)
-    return (g_rtcTime % SECS_PER_DAY) / 60; // number of minutes from midnight
-#else
-    return 0;
-#endif
-  }
-  else if (i <= MIXSRC_LAST_TIMER) {
-    return timersStates[i-MIXSRC_FIRST_TIMER].val;
-  }
-#else
   else if (i == MIXSRC_FIRST_TELEM-1+TELEM_TX_VOLTAGE) {
     return g_vbat100mV;
   }
   else if (i <= MIXSRC_FIRST_TELEM-1+TELEM_TIMER2) {
     return timersStates[i-MIXSRC_FIRST_TELEM+1-TELEM_TIMER1].val;
   }
-#endif
 
-#if defined(CPUARM)
-  else if (i <= MIXSRC_LAST_TELEM) {
-    if(IS_FAI_FORBIDDEN(i)) {
-      return 0;
-    }
-    i -= MIXSRC_FIRST_TELEM;
-    div_t qr = div(i, 3);
-    TelemetryItem & telemetryItem = telemetryItems[qr.quot];
-    switch (qr.rem) {
-      case 1:
-        return telemetryItem.valueMin;
-      case 2:
-        return telemetryItem.valueMax;
-      default:
-        return telemetryItem.value;
-    }
-  }
-#elif defined(TELEMETRY_FRSKY)
+#if defined(TELEMETRY_FRSKY)
   else if (i==MIXSRC_FIRST_TELEM-1+TELEM_RSSI_TX) return telemetryData.rssi[1].value;
   else if (i==MIXSRC_FIRST_TELEM-1+TELEM_RSSI_RX) return telemetryData.rssi[0].value;
   else if (i==MIXSRC_FIRST_TELEM-1+TELEM_A1) return telemetryData.analog[TELEM_ANA_A1].value;
@@ -504,6 +648,7 @@ getvalue_t getValue(mixsrc_t i)
 #endif
   else return 0;
 }
+#endif
 
 void evalInputs(uint8_t mode)
 {
@@ -673,13 +818,175 @@ int getSourceTrimValue(int source, int stickValue=0)
 }
 #endif
 
+#if defined(CPUARM)
+// The mixer plan is the list of mix lines, decoded once when the model is
+// loaded or edited, so that the mixer loop doesn't need to decode sources,
+// weights and offsets again on each pass. Destination channels are sorted
+// so that a channel used as a source is computed before the channels using
+// it. Only recursive channels still need more than one mixer pass.
+
+#define MIXPLAN_FIRST_LINE       0x01 // first line of its destination channel
+#define MIXPLAN_WEIGHT_GVAR      0x02 // weight has to be read each pass
+#define MIXPLAN_OFFSET_GVAR      0x04 // offset has to be read each pass
+#define MIXPLAN_SOURCE_CHANNEL   0x08 // srcIndex is a channel
+#define MIXPLAN_SOURCE_TRAINER   0x10
+#define MIXPLAN_SOURCE_LUA       0x20 // srcIndex is a script index
+
+struct MixPlanLine {
+  uint8_t index;   // index in g_model.mixData[], swOn[] and act[]
+  uint8_t destCh;
+  uint8_t flags;
+  uint8_t srcIndex;
+  int32_t weight;  // already scaled with calc100to256_16Bits()
+  int32_t offset;  // already scaled to the chans[] range
+};
+
+struct MixPlan {
+  uint8_t count;
+  bitfield_channels_t channels; // channels which have mix lines
+  MixPlanLine lines[MAX_MIXERS];
+};
+
+MixPlan mixerPlan;
+volatile bool mixerPlanDirty = true;
+
+void invalidateMixerPlan()
+{
+  mixerPlanDirty = true;
+}
+
+static bool isMixGVarValue(int16_t value)
+{
+#if defined(GVARS)
+  return GV_IS_GV_VALUE(value, GV_RANGELARGE_NEG, GV_RANGELARGE);
+#else
+  return false;
+#endif
+}
+
+static void decodeMixPlanLine(MixPlanLine & line, uint8_t index)
+{
+  MixData * md = mixAddress(index);
+
+  line.index = index;
+  line.destCh = md->destCh;
+  line.flags = 0;
+  line.srcIndex = 0;
+
+  if (md->srcRaw >= MIXSRC_FIRST_TRAINER && md->srcRaw <= MIXSRC_LAST_TRAINER) {
+    line.flags |= MIXPLAN_SOURCE_TRAINER;
+  }
+  else if (md->srcRaw >= MIXSRC_CH1 && md->srcRaw <= MIXSRC_LAST_CH) {
+    line.flags |= MIXPLAN_SOURCE_CHANNEL;
+    line.srcIndex = md->srcRaw - MIXSRC_CH1;
+  }
+#if defined(LUA_MODEL_SCRIPTS)
+  else if (md->srcRaw >= MIXSRC_FIRST_LUA && md->srcRaw <= MIXSRC_LAST_LUA) {
+    line.flags |= MIXPLAN_SOURCE_LUA;
+    line.srcIndex = (md->srcRaw - MIXSRC_FIRST_LUA) / MAX_SCRIPT_OUTPUTS;
+  }
+#endif
+
+  if (isMixGVarValue(MD_WEIGHT(md))) {
+    line.flags |= MIXPLAN_WEIGHT_GVAR;
+    line.weight = 0;
+  }
+  else {
+    line.weight = calc100to256_16Bits(GET_GVAR_PREC1(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE, 0));
+  }
+
+  if (isMixGVarValue(MD_OFFSET(md))) {
+    line.flags |= MIXPLAN_OFFSET_GVAR;
+    line.offset = 0;
+  }
+  else {
+    int32_t offset = GET_GVAR_PREC1(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE, 0);
+    line.offset = offset ? div_and_round(calc100toRESX_16Bits(offset), 10) << 8 : 0;
+  }
+}
+
+void buildMixerPlan()
+{
+  // the groups of consecutive lines with the same destination channel
+  // (static to keep them out of the mixer task stack)
+  static uint8_t groupStart[MAX_MIXERS+1];
+  static bitfield_channels_t groupSources[MAX_MIXERS];
+  uint8_t groupsCount = 0;
+  bool duplicateChannel = false;
+
+  mixerPlanDirty = false;
+  mixerPlan.channels = 0;
+
+  uint8_t count = 0;
+  for (; count<MAX_MIXERS; count++) {
+    MixData * md = mixAddress(count);
+    if (md->srcRaw == 0)
+      break;
+    bitfield_channels_t destMask = (bitfield_channels_t)1 << md->destCh;
+    if (count == 0 || md->destCh != (md-1)->destCh) {
+      if (mixerPlan.channels & destMask)
+        duplicateChannel = true;
+      mixerPlan.channels |= destMask;
+      groupSources[groupsCount] = 0;
+      groupStart[groupsCount++] = count;
+    }
+    if (md->srcRaw >= MIXSRC_CH1 && md->srcRaw <= MIXSRC_LAST_CH && md->srcRaw-MIXSRC_CH1 != md->destCh) {
+      groupSources[groupsCount-1] |= (bitfield_channels_t)1 << (md->srcRaw - MIXSRC_CH1);
+    }
+  }
+  groupStart[groupsCount] = count;
+
+  // topological sort of the groups, keeping the model order whenever possible
+  // recursive channels (and channels split in several groups) are kept in
+  // the model order and will be evaluated in several passes as before
+  bitfield_channels_t doneChannels = 0;
+  uint64_t doneGroups = 0;
+  uint8_t line = 0;
+  while (line < count) {
+    int8_t next = -1;
+    if (!duplicateChannel) {
+      for (uint8_t g=0; g<groupsCount; g++) {
+        if (!(doneGroups & ((uint64_t)1 << g)) && !(groupSources[g] & mixerPlan.channels & ~doneChannels)) {
+          next = g;
+          break;
+        }
+      }
+    }
+    if (next < 0) {
+      // cycle: take the first remaining group
+      for (uint8_t g=0; g<groupsCount; g++) {
+        if (!(doneGroups & ((uint64_t)1 << g))) {
+          next = g;
+          break;
+        }
+      }
+    }
+    doneGroups |= (uint64_t)1 << next;
+    for (uint8_t i=groupStart[next]; i<groupStart[next+1]; i++) {
+      MixPlanLine & planLine = mixerPlan.lines[line++];
+      decodeMixPlanLine(planLine, i);
+      if (i == groupStart[next]) {
+        planLine.flags |= MIXPLAN_FIRST_LINE;
+        doneChannels |= (bitfield_channels_t)1 << planLine.destCh;
+      }
+    }
+  }
+
+  mixerPlan.count = count;
+}
+#endif
+
 uint8_t mixerCurrentFlightMode;
 void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
 {
+  PROFILER_STAGE(PROFILER_STAGE_INPUTS);
   evalInputs(mode);
 
+  PROFILER_STAGE(PROFILER_STAGE_LOGICAL_SWITCHES);
   if (tick10ms) evalLogicalSwitches(mode==e_perout_mode_normal);
 
+  PROFILER_STAGE(PROFILER_STAGE_MIXES);
+
 #if defined(MODULE_ALWAYS_SEND_PULSES)
   checkStartupWarnings();
 #endif
@@ -764,6 +1071,12 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
   }
 #endif
 
+#if defined(CPUARM)
+  if (mixerPlanDirty) {
+    buildMixerPlan();
+  }
+#endif
+
   memclear(chans, sizeof(chans));        // All outputs to 0
 
   //========== MIXER LOOP ===============
@@ -777,6 +1090,28 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
 
     bitfield_channels_t passDirtyChannels = 0;
 
+#if defined(CPUARM)
+    // channels already evaluated in this pass (channels without mix lines are always 0)
+    bitfield_channels_t passDoneChannels = ~mixerPlan.channels;
+
+    for (uint8_t l=0; l<mixerPlan.count; l++) {
+      const MixPlanLine & line = mixerPlan.lines[l];
+      uint8_t i = line.index;
+
+#if defined(BOLD_FONT)
+      if (mode==e_perout_mode_normal && pass==0) swOn[i].activeMix = 0;
+#endif
+
+      MixData *md = mixAddress(i);
+
+      if (!(dirtyChannels & ((bitfield_channels_t)1 << line.destCh))) continue;
+
+      // if this is the first calculation for the destination channel, initialize it with 0 (otherwise would be random)
+      if (line.flags & MIXPLAN_FIRST_LINE) {
+        chans[line.destCh] = 0;
+        passDoneChannels |= (bitfield_channels_t)1 << line.destCh;
+      }
+#else
     for (uint8_t i=0; i<MAX_MIXERS; i++) {
 
 #if defined(BOLD_FONT)
@@ -795,6 +1130,7 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
       if (i == 0 || md->destCh != (md-1)->destCh) {
         chans[md->destCh] = 0;
       }
+#endif
 
       //========== FLIGHT MODE && SWITCH =====
       bool mixCondition = (md->flightModes != 0 || md->swtch);
@@ -802,17 +1138,20 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
 
 #define MIXER_LINE_DISABLE()   (mixCondition = true, mixEnabled = 0)
 
+#if defined(CPUARM)
+      if (mixEnabled && (line.flags & MIXPLAN_SOURCE_TRAINER) && !IS_TRAINER_INPUT_VALID()) {
+        MIXER_LINE_DISABLE();
+      }
+#else
       if (mixEnabled && md->srcRaw >= MIXSRC_FIRST_TRAINER && md->srcRaw <= MIXSRC_LAST_TRAINER && !IS_TRAINER_INPUT_VALID()) {
         MIXER_LINE_DISABLE();
       }
+#endif
 
 #if defined(LUA_MODEL_SCRIPTS)
       // disable mixer if Lua script is used as source and script was killed
-      if (mixEnabled && md->srcRaw >= MIXSRC_FIRST_LUA && md->srcRaw <= MIXSRC_LAST_LUA) {
-        div_t qr = div(md->srcRaw-MIXSRC_FIRST_LUA, MAX_SCRIPT_OUTPUTS);
-        if (scriptInternalData[qr.quot].state != SCRIPT_OK) {
-          MIXER_LINE_DISABLE();
-        }
+      if (mixEnabled && (line.flags & MIXPLAN_SOURCE_LUA) && scriptInternalData[line.srcIndex].state != SCRIPT_OK) {
+        MIXER_LINE_DISABLE();
       }
 #endif
 
@@ -843,6 +1182,16 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
         else
 #endif
         {
+#if defined(CPUARM)
+          v = getValue(md->srcRaw);
+          if ((line.flags & MIXPLAN_SOURCE_CHANNEL) && line.destCh != line.srcIndex) {
+            bitfield_channels_t srcMask = (bitfield_channels_t)1 << line.srcIndex;
+            if (dirtyChannels & srcMask & (passDirtyChannels|~passDoneChannels))
+              passDirtyChannels |= (bitfield_channels_t)1 << line.destCh;
+            if ((passDoneChannels & srcMask) || pass > 0)
+              v = chans[line.srcIndex] >> 8;
+          }
+#else
           mixsrc_t srcRaw = MIXSRC_Rud + stickIndex;
           v = getValue(srcRaw);
           srcRaw -= MIXSRC_CH1;
@@ -852,6 +1201,7 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
             if (srcRaw < md->destCh || pass > 0)
               v = chans[srcRaw] >> 8;
           }
+#endif
         }
         if (!mixCondition) {
           mixEnabled = v >> DELAY_POS_SHIFT;
@@ -929,8 +1279,11 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
       }
 
 #if defined(CPUARM)
-      int32_t weight = GET_GVAR_PREC1(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
-      weight = calc100to256_16Bits(weight);
+      int32_t weight = line.weight;
+      if (line.flags & MIXPLAN_WEIGHT_GVAR) {
+        weight = GET_GVAR_PREC1(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
+        weight = calc100to256_16Bits(weight);
+      }
 #else
       // saves 12 bytes code if done here and not together with weight; unknown reason
       int16_t weight = GET_GVAR(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
@@ -997,8 +1350,13 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
       //========== OFFSET / AFTER ===============
       if (apply_offset_and_curve) {
 #if defined(CPUARM)
-        int32_t offset = GET_GVAR_PREC1(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
-        if (offset) dv += div_and_round(calc100toRESX_16Bits(offset), 10) << 8;
+        if (line.flags & MIXPLAN_OFFSET_GVAR) {
+          int32_t offset = GET_GVAR_PREC1(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
+          if (offset) dv += div_and_round(calc100toRESX_16Bits(offset), 10) << 8;
+        }
+        else {
+          dv += line.offset;
+        }
 #else
         int16_t offset = GET_GVAR(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
         if (offset) dv += int32_t(calc100toRESX_16Bits(offset)) << 8;
@@ -1185,6 +1543,7 @@ void evalMixes(uint8_t tick10ms)
   //========== FUNCTIONS ===============
   // must be done after mixing because some functions use the inputs/channels values
   // must be done before limits because of the applyLimit function: it checks for safety switches which would be not initialized otherwise
+  PROFILER_STAGE(PROFILER_STAGE_FUNCTIONS);
   if (tick10ms) {
 #if defined(MASTER_VOLUME)
     requiredSpeakerVolume = g_eeGeneral.speakerVolume + VOLUME_LEVEL_DEF;
@@ -1201,6 +1560,7 @@ void evalMixes(uint8_t tick10ms)
   }
 
   //========== LIMITS ===============
+  PROFILER_STAGE(PROFILER_STAGE_LIMITS);
   for (uint8_t i=0; i<MAX_OUTPUT_CHANNELS; i++) {
     // chans[i] holds data from mixer.   chans[i] = v*weight => 1024*256
     // later we multiply by the limit (up to 100) and then we need to normalize
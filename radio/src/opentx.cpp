@@ -1732,6 +1732,7 @@ void doMixerCalculations()
   getADC_bandgap();
 #endif
 
+  PROFILER_STAGE(PROFILER_STAGE_TIMERS);
   DEBUG_TIMER_START(debugTimerMixes10ms);
   if (tick10ms) {
 
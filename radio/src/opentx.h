@@ -702,8 +702,31 @@ extern uint8_t flightModeTransitionLast;
 void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms);
 void evalMixes(uint8_t tick10ms);
 void doMixerCalculations();
+#if defined(CPUARM)
+void invalidateMixerPlan();
+#endif
 void scheduleNextMixerCalculation(uint8_t module, uint16_t period_ms);
 
+#if defined(CPUARM)
+#define MIXER_DURATION_SAMPLES         16
+
+struct MixerSchedulerStats
+{
+  uint32_t frames;
+  uint32_t staleFrames;   // frames sent without a mixer run since the previous frame of the same module
+};
+
+extern uint32_t nextMixerTime[NUM_MODULES];
+extern uint8_t mixerPeriodTicks[NUM_MODULES];
+extern uint8_t mixerPredictions[NUM_MODULES];
+extern uint16_t mixerDurationEstimate;
+extern MixerSchedulerStats mixerSchedulerStats;
+void updateMixerDurationEstimate(uint16_t duration);
+uint32_t getMixerDelay(uint32_t now, uint32_t lastRunTime);
+void predictNextMixerTimes(uint32_t now);
+void resetMixerScheduler();
+#endif
+
 #if defined(CPUARM)
   void checkTrims();
 #endif
@@ -1114,6 +1137,7 @@ void loadCurves();
 int intpol(int x, uint8_t idx);
 int applyCurve(int x, CurveRef & curve);
 int applyCustomCurve(int x, uint8_t idx);
+void invalidateCurves();
 int applyCurrentCurve(int x);
 int8_t getCurveX(int noPoints, int point);
 void resetCustomCurveX(int8_t * points, int noPoints);
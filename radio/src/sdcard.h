@@ -43,6 +43,9 @@
 #define SCRIPTS_MIXES_PATH  SCRIPTS_PATH "/MIXES"
 #define SCRIPTS_FUNCS_PATH  SCRIPTS_PATH "/FUNCTIONS"
 #define SCRIPTS_TELEM_PATH  SCRIPTS_PATH "/TELEMETRY"
+#define SCRIPTS_CACHE_PATH  SCRIPTS_PATH "/CACHE"
+#define SCRIPTS_CACHE_INDEX SCRIPTS_CACHE_PATH "/index.bin"
+#define MODELS_THUMBS_PATH  MODELS_PATH "/THUMBS"
 
 #define LEN_FILE_PATH_MAX   (sizeof(SCRIPTS_TELEM_PATH)+1)  // longest + "/"
 
@@ -53,7 +56,11 @@ const char RADIO_SETTINGS_PATH[] = RADIO_PATH "/radio.bin";
 #endif
 
 #define MODELS_EXT          ".bin"
+#if defined(LOG_BINARY)
+#define LOGS_EXT            ".blg"
+#else
 #define LOGS_EXT            ".csv"
+#endif
 #define SOUNDS_EXT          ".wav"
 #define BMP_EXT             ".bmp"
 #define PNG_EXT             ".png"
@@ -29,10 +29,20 @@ EeFs      eeFs;
 
 #if defined(CPUARM)
 blkid_t   freeBlocks = 0;
+EepromStats eepromStats;
 #endif
 
 uint8_t s_sync_write = false;
 
+static void EeFsWrite(uint8_t * buffer, size_t address, size_t size)
+{
+#if defined(CPUARM)
+  eepromStats.writes++;
+  eepromStats.bytes += size;
+#endif
+  eepromWriteBlock(buffer, address, size);
+}
+
 static uint8_t EeFsRead(blkid_t blk, uint8_t ofs)
 {
   uint8_t byte;
@@ -55,7 +65,7 @@ static void EeFsSetLink(blkid_t blk, blkid_t val)
 {
   static blkid_t s_link; // we write asynchronously, then nothing on the stack!
   s_link = val;
-  eepromWriteBlock((uint8_t *)&s_link, (blk*BS)+BLOCKS_OFFSET, sizeof(blkid_t));
+  EeFsWrite((uint8_t *)&s_link, (blk*BS)+BLOCKS_OFFSET, sizeof(blkid_t));
 }
 
 static uint8_t EeFsGetDat(blkid_t blk, uint8_t ofs)
@@ -63,24 +73,38 @@ static uint8_t EeFsGetDat(blkid_t blk, uint8_t ofs)
   return EeFsRead(blk, ofs+sizeof(blkid_t));
 }
 
-static void EeFsSetDat(blkid_t blk, uint8_t ofs, uint8_t *buf, uint8_t len)
+/*
+ * Returns false when the data was already there. Files are written in the blocks of FILE_TMP,
+ * which most often hold the previous version of the same file, then only the changes are written.
+ */
+static bool EeFsSetDat(blkid_t blk, uint8_t ofs, uint8_t *buf, uint8_t len)
 {
-  eepromWriteBlock(buf, (blk*BS)+ofs+sizeof(blkid_t)+BLOCKS_OFFSET, len);
+  size_t address = (blk*BS)+ofs+sizeof(blkid_t)+BLOCKS_OFFSET;
+#if defined(CPUARM)
+  uint8_t previous[BS-sizeof(blkid_t)];
+  eepromReadBlock(previous, address, len);
+  if (!memcmp(previous, buf, len)) {
+    eepromStats.skippedBytes += len;
+    return false;
+  }
+#endif
+  EeFsWrite(buf, address, len);
+  return true;
 }
 
 static void EeFsFlushFreelist()
 {
-  eepromWriteBlock((uint8_t *)&eeFs.freeList, offsetof(EeFs, freeList), sizeof(eeFs.freeList));
+  EeFsWrite((uint8_t *)&eeFs.freeList, offsetof(EeFs, freeList), sizeof(eeFs.freeList));
 }
 
 static void EeFsFlushDirEnt(uint8_t i_fileId)
 {
-  eepromWriteBlock((uint8_t *)&eeFs.files[i_fileId], offsetof(EeFs, files) + sizeof(DirEnt)*i_fileId, sizeof(DirEnt));
+  EeFsWrite((uint8_t *)&eeFs.files[i_fileId], offsetof(EeFs, files) + sizeof(DirEnt)*i_fileId, sizeof(DirEnt));
 }
 
 static void EeFsFlush()
 {
-  eepromWriteBlock((uint8_t *)&eeFs, 0, sizeof(eeFs));
+  EeFsWrite((uint8_t *)&eeFs, 0, sizeof(eeFs));
 }
 
 uint16_t EeFsGetFree()
@@ -414,8 +438,9 @@ void RlcFile::nextWriteStep()
     m_write_len -= tmp;
     m_ofs += tmp;
     m_pos += tmp;
-    EeFsSetDat(m_currBlk, m_ofs-tmp, m_write_buf-tmp, tmp);
-    return;
+    if (EeFsSetDat(m_currBlk, m_ofs-tmp, m_write_buf-tmp, tmp) || !m_write_len) {
+      return;
+    }
   }
 
   if (s_write_err == ERR_FULL) {
@@ -648,6 +673,10 @@ void RlcFile::writeRlc(uint8_t i_fileId, uint8_t typ, uint8_t *buf, uint16_t i_l
 {
   create(i_fileId, typ, sync_write);
 
+#if defined(CPUARM)
+  eepromStats.files++;
+#endif
+
   m_write_step = WRITE_START_STEP;
   m_rlc_buf = buf;
   m_rlc_len = i_len;
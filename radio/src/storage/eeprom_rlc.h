@@ -177,6 +177,17 @@ class RlcFile: public EFile
 
 extern RlcFile theFile;  //used for any file operation
 
+#if defined(CPUARM)
+struct EepromStats {
+  uint32_t files;         // files written
+  uint32_t writes;        // EEPROM write operations
+  uint32_t bytes;         // bytes written
+  uint32_t skippedBytes;  // bytes which were not written because they had not changed
+};
+
+extern EepromStats eepromStats;
+#endif
+
 inline void eeFlush()
 {
   theFile.flush();
@@ -53,18 +53,30 @@ class ModelCell
 
     void load()
     {
-      PACK(struct {
-        ModelHeader header;
-        TimerData timers[MAX_TIMERS];
-      }) partialmodel;
-      const char * error = NULL;
-
       buffer = new BitmapBuffer(BMP_RGB565, MODELCELL_WIDTH, MODELCELL_HEIGHT);
       if (buffer == NULL) {
         return;
       }
 
+      // the current model may have unsaved changes, it is always drawn from g_model
       if (strncmp(modelFilename, g_eeGeneral.currModelFilename, LEN_MODEL_FILENAME) == 0) {
+        draw(true);
+      }
+      else if (!loadThumbnail()) {
+        draw(false);
+        saveThumbnail();
+      }
+    }
+
+    void draw(bool current)
+    {
+      PACK(struct {
+        ModelHeader header;
+        TimerData timers[MAX_TIMERS];
+      }) partialmodel;
+      const char * error = NULL;
+
+      if (current) {
         memcpy(&partialmodel.header, &g_model.header, sizeof(partialmodel));
       }
       else {
@@ -72,8 +84,10 @@ class ModelCell
       }
 
       buffer->clear(TEXT_BGCOLOR);
+      memclear(bitmapFilename, sizeof(bitmapFilename));
 
       if (error) {
+        modelName[0] = '\0';
         buffer->drawText(5, 2, "(Invalid Model)", TEXT_COLOR);
         buffer->drawBitmapPattern(5, 23, LBM_LIBRARY_SLOT, TEXT_COLOR);
       }
@@ -100,6 +114,7 @@ class ModelCell
           buffer->drawBitmapPattern(104+i*11, 25, LBM_SCORE0, TITLE_BGCOLOR);
         }
         GET_FILENAME(filename, BITMAPS_PATH, partialmodel.header.bitmap, "");
+        memcpy(bitmapFilename, filename, sizeof(filename));
         const BitmapBuffer * bitmap = BitmapBuffer::load(filename);
         if (bitmap) {
           buffer->drawScaledBitmap(bitmap, 5, 24, 56, 32);
@@ -112,8 +127,105 @@ class ModelCell
       buffer->drawSolidHorizontalLine(5, 19, 143, LINE_COLOR);
     }
 
+    // The cell drawn from a model depends on the model file, the model bitmap and the theme colors
+    PACK(struct ThumbnailHeader {
+      uint32_t fourcc;
+      uint32_t modelDate;
+      uint32_t bitmapDate;
+      uint32_t colorsHash;
+      char bitmapFilename[sizeof(BITMAPS_PATH) + LEN_BITMAP_NAME + 1];
+      char modelName[LEN_MODEL_NAME+1];
+    });
+
+    static uint32_t getFileDate(const char * path)
+    {
+      FILINFO info;
+      if (f_stat(path, &info) != FR_OK) {
+        return 0;
+      }
+      return ((uint32_t)info.fdate << 16) + info.ftime;
+    }
+
+    bool getThumbnailHeader(ThumbnailHeader & header)
+    {
+      char path[256];
+      getModelPath(path, modelFilename);
+      memclear(&header, sizeof(header));
+      header.fourcc = OTX_FOURCC;
+      header.modelDate = getFileDate(path);
+      header.colorsHash = hash(lcdColorTable, sizeof(lcdColorTable));
+      return header.modelDate != 0;
+    }
+
+    bool loadThumbnail()
+    {
+      ThumbnailHeader expected, header;
+      char path[256];
+      FIL file;
+      UINT read;
+
+      if (!getThumbnailHeader(expected)) {
+        return false;
+      }
+
+      getModelThumbnailPath(path, modelFilename);
+      if (f_open(&file, path, FA_OPEN_EXISTING | FA_READ) != FR_OK) {
+        return false;
+      }
+
+      bool result = false;
+      if (f_size(&file) == sizeof(header) + buffer->getDataSize() &&
+          f_read(&file, &header, sizeof(header), &read) == FR_OK && read == sizeof(header) &&
+          header.fourcc == expected.fourcc && header.modelDate == expected.modelDate && header.colorsHash == expected.colorsHash) {
+        header.bitmapFilename[sizeof(header.bitmapFilename)-1] = '\0';
+        if (header.bitmapFilename[0] == '\0' || getFileDate(header.bitmapFilename) == header.bitmapDate) {
+          result = (f_read(&file, buffer->getData(), buffer->getDataSize(), &read) == FR_OK && read == buffer->getDataSize());
+          memcpy(bitmapFilename, header.bitmapFilename, sizeof(bitmapFilename));
+          memcpy(modelName, header.modelName, sizeof(modelName));
+        }
+      }
+
+      f_close(&file);
+      return result;
+    }
+
+    void saveThumbnail()
+    {
+      ThumbnailHeader header;
+      char path[256];
+      FIL file;
+      UINT written;
+
+      if (!getThumbnailHeader(header)) {
+        return;
+      }
+
+      memcpy(header.bitmapFilename, bitmapFilename, sizeof(header.bitmapFilename));
+      if (bitmapFilename[0]) {
+        header.bitmapDate = getFileDate(bitmapFilename);
+      }
+      memcpy(header.modelName, modelName, sizeof(header.modelName));
+
+      getModelThumbnailPath(path, modelFilename);
+      FRESULT result = f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE);
+      if (result == FR_NO_PATH) {
+        sdCheckAndCreateDirectory(MODELS_THUMBS_PATH);
+        result = f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE);
+      }
+      if (result != FR_OK) {
+        return;
+      }
+
+      // a partially written file is rejected by its size
+      if (f_write(&file, &header, sizeof(header), &written) == FR_OK && written == sizeof(header)) {
+        f_write(&file, buffer->getData(), buffer->getDataSize(), &written);
+      }
+      f_close(&file);
+    }
+
     char modelFilename[LEN_MODEL_FILENAME+1];
     char modelName[LEN_MODEL_NAME+1];
+    char bitmapFilename[sizeof(BITMAPS_PATH) + LEN_BITMAP_NAME + 1];
     BitmapBuffer * buffer;
 };
 
@@ -142,6 +254,7 @@ class ModelsCategory: public std::list<ModelCell *>
 
     void removeModel(ModelCell * model)
     {
+      invalidateModelThumbnail(model->modelFilename);
       delete model;
       remove(model);
     }
@@ -313,6 +426,31 @@ class ModelsList
       save();
     }
 
+    // Loads one model cell not yet displayed, the current category first
+    bool prefetch()
+    {
+      if (currentCategory && prefetch(currentCategory)) {
+        return true;
+      }
+      for (std::list<ModelsCategory *>::iterator it = categories.begin(); it != categories.end(); ++it) {
+        if (*it != currentCategory && prefetch(*it)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    bool prefetch(ModelsCategory * category)
+    {
+      for (std::list<ModelCell *>::iterator it = category->begin(); it != category->end(); ++it) {
+        if (!(*it)->buffer) {
+          (*it)->load();
+          return true;
+        }
+      }
+      return false;
+    }
+
     void moveModel(ModelsCategory * category, ModelCell * model, int8_t step)
     {
       category->moveModel(model, step);
@@ -27,6 +27,13 @@ void getModelPath(char * path, const char * filename)
   strcpy(&path[sizeof(MODELS_PATH)], filename);
 }
 
+void getTemporaryPath(char * path, const char * filename)
+{
+  strcpy(path, filename);
+  strcat(path, ".tmp");
+}
+
+// The file is first written under a temporary name, then renamed, so that a power loss never leaves a truncated file
 const char * writeFile(const char * filename, const uint8_t * data, uint16_t size)
 {
   TRACE("writeFile(%s)", filename);
@@ -34,8 +41,11 @@ const char * writeFile(const char * filename, const uint8_t * data, uint16_t siz
   FIL file;
   unsigned char buf[8];
   UINT written;
+  char path[256];
+
+  getTemporaryPath(path, filename);
 
-  FRESULT result = f_open(&file, filename, FA_CREATE_ALWAYS | FA_WRITE);
+  FRESULT result = f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE);
   if (result != FR_OK) {
     return SDCARD_ERROR(result);
   }
@@ -57,15 +67,48 @@ const char * writeFile(const char * filename, const uint8_t * data, uint16_t siz
     return SDCARD_ERROR(result);
   }
 
-  f_close(&file);
+  result = f_close(&file);
+  if (result != FR_OK) {
+    return SDCARD_ERROR(result);
+  }
+
+  result = f_unlink(filename);
+  if (result != FR_OK && result != FR_NO_FILE) {
+    return SDCARD_ERROR(result);
+  }
+
+  result = f_rename(path, filename);
+  if (result != FR_OK) {
+    return SDCARD_ERROR(result);
+  }
+
   return NULL;
 }
 
-const char * writeModel()
+#if defined(COLORLCD)
+void getModelThumbnailPath(char * path, const char * filename)
+{
+  strcpy(path, MODELS_THUMBS_PATH);
+  path[sizeof(MODELS_THUMBS_PATH)-1] = '/';
+  strcpy(&path[sizeof(MODELS_THUMBS_PATH)], filename);
+}
+
+void invalidateModelThumbnail(const char * filename)
+{
+  char path[256];
+  getModelThumbnailPath(path, filename);
+  f_unlink(path);
+}
+#endif
+
+const char * writeModel(const char * filename, const ModelData * model)
 {
   char path[256];
-  getModelPath(path, g_eeGeneral.currModelFilename);
-  return writeFile(path, (uint8_t *)&g_model, sizeof(g_model));
+  getModelPath(path, filename);
+#if defined(COLORLCD)
+  invalidateModelThumbnail(filename);
+#endif
+  return writeFile(path, (uint8_t *)model, sizeof(ModelData));
 }
 
 const char * loadFile(const char * filename, uint8_t * data, uint16_t maxsize)
@@ -77,6 +120,14 @@ const char * loadFile(const char * filename, uint8_t * data, uint16_t maxsize)
   UINT read;
 
   FRESULT result = f_open(&file, filename, FA_OPEN_EXISTING | FA_READ);
+  if (result == FR_NO_FILE) {
+    // the power was lost between the removal of the old file and the rename of the new one
+    char path[256];
+    getTemporaryPath(path, filename);
+    if (f_rename(path, filename) == FR_OK) {
+      result = f_open(&file, filename, FA_OPEN_EXISTING | FA_READ);
+    }
+  }
   if (result != FR_OK) {
     return SDCARD_ERROR(result);
   }
@@ -146,35 +197,186 @@ const char * loadRadioSettingsSettings()
   return error;
 }
 
-const char * writeGeneralSettings()
+const char * writeGeneralSettings(const RadioData * settings)
 {
-  return writeFile(RADIO_SETTINGS_PATH, (uint8_t *)&g_eeGeneral, sizeof(g_eeGeneral));
+  return writeFile(RADIO_SETTINGS_PATH, (uint8_t *)settings, sizeof(RadioData));
 }
 
-void storageCheck(bool immediately)
+StorageStats storageStats;
+
+/*
+ * The settings and the model are copied in a snapshot by the menus task, then written by the storage task.
+ * There are two snapshots: while one is written, the other one collects the next changes. Changes which
+ * arrive before the pending snapshot is taken by the storage task are merged in it.
+ */
+struct StorageSnapshot
+{
+  uint8_t msk;
+  char modelFilename[LEN_MODEL_FILENAME+1];
+  RadioData settings;
+  ModelData model;
+};
+
+StorageSnapshot storageSnapshots[2] __SDRAM;
+StorageSnapshot * storagePendingSnapshot = &storageSnapshots[0];
+
+#if !defined(SIMU)
+OS_TID storageTaskId;
+bool storageTaskRunning = false;
+TaskStack<STORAGE_STACK_SIZE> storageStack;
+OS_MutexID storageSnapshotMutex; // protects the pending snapshot
+OS_MutexID storageWriteMutex;    // held while writing a snapshot
+OS_FlagID storageFlag;
+#define STORAGE_LOCK(mutex)      do { if (storageTaskRunning) CoEnterMutexSection(mutex); } while (0)
+#define STORAGE_UNLOCK(mutex)    do { if (storageTaskRunning) CoLeaveMutexSection(mutex); } while (0)
+#else
+#define storageTaskRunning       false
+#define STORAGE_LOCK(mutex)
+#define STORAGE_UNLOCK(mutex)
+#endif
+
+static bool storageTakeSnapshot(StorageSnapshot * snapshot)
 {
+  if ((storageDirtyMsk & EE_MODEL) && (snapshot->msk & EE_MODEL) && strncmp(snapshot->modelFilename, g_eeGeneral.currModelFilename, LEN_MODEL_FILENAME)) {
+    // the model has been changed, the previous one has to be written first
+    return false;
+  }
+
+  if (snapshot->msk & storageDirtyMsk) {
+    storageStats.coalesced++;
+  }
+
   if (storageDirtyMsk & EE_GENERAL) {
+    memcpy(&snapshot->settings, &g_eeGeneral, sizeof(RadioData));
+  }
+
+  if (storageDirtyMsk & EE_MODEL) {
+    memcpy(snapshot->modelFilename, g_eeGeneral.currModelFilename, sizeof(g_eeGeneral.currModelFilename));
+    snapshot->modelFilename[LEN_MODEL_FILENAME] = '\0';
+    memcpy(&snapshot->model, &g_model, sizeof(ModelData));
+  }
+
+  snapshot->msk |= storageDirtyMsk;
+  storageDirtyMsk = 0;
+  return true;
+}
+
+static void storageWriteSnapshot(StorageSnapshot * snapshot)
+{
+  tmr10ms_t start = get_tmr10ms();
+
+  if (snapshot->msk & EE_GENERAL) {
     TRACE("eeprom write general");
-    storageDirtyMsk -= EE_GENERAL;
-    const char * error = writeGeneralSettings();
+    const char * error = writeGeneralSettings(&snapshot->settings);
     if (error) {
       TRACE("writeGeneralSettings error=%s", error);
+      storageStats.errors++;
     }
+    storageStats.bytes += sizeof(RadioData);
   }
 
-  if (storageDirtyMsk & EE_MODEL) {
+  if (snapshot->msk & EE_MODEL) {
     TRACE("eeprom write model");
-    storageDirtyMsk -= EE_MODEL;
-    const char * error = writeModel();
+    const char * error = writeModel(snapshot->modelFilename, &snapshot->model);
     if (error) {
       TRACE("writeModel error=%s", error);
+      storageStats.errors++;
     }
+    storageStats.bytes += sizeof(ModelData);
+  }
+
+  snapshot->msk = 0;
+  storageStats.writes++;
+
+  tmr10ms_t duration = get_tmr10ms() - start;
+  if (duration > storageStats.maxDuration) {
+    storageStats.maxDuration = duration;
   }
 }
 
+static void storageFlush()
+{
+  STORAGE_LOCK(storageWriteMutex);
+  STORAGE_LOCK(storageSnapshotMutex);
+  if (!storageTakeSnapshot(storagePendingSnapshot)) {
+    storageWriteSnapshot(storagePendingSnapshot);
+    storageTakeSnapshot(storagePendingSnapshot);
+  }
+  if (storagePendingSnapshot->msk) {
+    storageWriteSnapshot(storagePendingSnapshot);
+  }
+  STORAGE_UNLOCK(storageSnapshotMutex);
+  STORAGE_UNLOCK(storageWriteMutex);
+}
+
+void storageCheck(bool immediately)
+{
+  if (immediately || !storageTaskRunning) {
+    storageFlush();
+    return;
+  }
+
+#if !defined(SIMU)
+  if (storageDirtyMsk) {
+    STORAGE_LOCK(storageSnapshotMutex);
+    bool taken = storageTakeSnapshot(storagePendingSnapshot);
+    STORAGE_UNLOCK(storageSnapshotMutex);
+    if (!taken) {
+      // the writing is still pending, the next check will retry
+      storageDirtyTime10ms = get_tmr10ms();
+    }
+    CoSetFlag(storageFlag);
+  }
+#endif
+}
+
+#if !defined(SIMU)
+void storageTask(void * pdata)
+{
+  while (1) {
+    CoWaitForSingleFlag(storageFlag, 0);
+
+    STORAGE_LOCK(storageWriteMutex);
+    STORAGE_LOCK(storageSnapshotMutex);
+    StorageSnapshot * snapshot = storagePendingSnapshot;
+    if (snapshot->msk) {
+      storagePendingSnapshot = (snapshot == &storageSnapshots[0] ? &storageSnapshots[1] : &storageSnapshots[0]);
+    }
+    STORAGE_UNLOCK(storageSnapshotMutex);
+
+    if (snapshot->msk) {
+      storageWriteSnapshot(snapshot);
+    }
+    STORAGE_UNLOCK(storageWriteMutex);
+  }
+}
+
+void storageStart()
+{
+  storageSnapshotMutex = CoCreateMutex();
+  storageWriteMutex = CoCreateMutex();
+  storageFlag = CoCreateFlag(true, false);
+  storageTaskId = CoCreateTask(storageTask, NULL, 12, &storageStack.stack[STORAGE_STACK_SIZE-1], STORAGE_STACK_SIZE);
+  storageTaskRunning = true;
+}
+
+void storageStackPaint()
+{
+  storageStack.paint();
+}
+
+uint16_t storageStackAvailable()
+{
+  return storageStack.available();
+}
+#endif
+
 void storageReadAll()
 {
   TRACE("storageReadAll");
+
+  // the snapshots are not initialized in SDRAM
+  storageSnapshots[0].msk = storageSnapshots[1].msk = 0;
   
   if (loadRadioSettingsSettings() != NULL) {
     storageEraseAll(true);
@@ -30,6 +30,32 @@ const char * readModel(const char * filename, uint8_t * buffer, uint32_t size);
 const char * loadModel(const char * filename, bool alarms=true);
 const char * createModel();
 
+void getModelPath(char * path, const char * filename);
+const char * writeFile(const char * filename, const uint8_t * data, uint16_t size);
+const char * loadFile(const char * filename, uint8_t * data, uint16_t maxsize);
+
+struct StorageStats {
+  uint32_t writes;
+  uint32_t coalesced;
+  uint32_t bytes;
+  uint32_t errors;
+  tmr10ms_t maxDuration;
+};
+
+extern StorageStats storageStats;
+
+#if !defined(SIMU)
+#define STORAGE_STACK_SIZE       800
+void storageStart();
+void storageStackPaint();
+uint16_t storageStackAvailable();
+#endif
+
+#if defined(COLORLCD)
+void getModelThumbnailPath(char * path, const char * filename);
+void invalidateModelThumbnail(const char * filename);
+#endif
+
 PACK(struct RamBackup {
   uint16_t size;
   uint8_t data[4094];
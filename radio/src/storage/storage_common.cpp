@@ -33,6 +33,21 @@ void storageDirty(uint8_t msk)
   storageDirtyMsk |= msk;
   storageDirtyTime10ms = get_tmr10ms();
 
+#if defined(CPUARM)
+  if (msk & EE_MODEL) {
+    invalidateMixerPlan();
+    invalidateTelemetrySensors();
+#if defined(CURVES)
+    invalidateCurves();
+#endif
+  }
+#endif
+
+#if defined(COLORLCD)
+  // widgets options, layouts and theme are part of the storage
+  invalidateWidgets();
+#endif
+
 #if defined(RAMBACKUP)
   rambackupDirtyMsk = storageDirtyMsk;
   rambackupDirtyTime10ms = storageDirtyTime10ms;
@@ -99,6 +114,11 @@ void postModelLoad(bool alarms)
 
   LOAD_MODEL_CURVES();
 
+#if defined(CPUARM)
+  invalidateMixerPlan();
+  invalidateTelemetrySensors();
+#endif
+
   resumeMixerCalculations();
   // TODO pulses should be started after mixer calculations ...
 
@@ -321,8 +321,8 @@ FRESULT f_open (FIL * fil, const TCHAR *name, BYTE flag)
   if (!(flag & FA_WRITE)) {
     struct stat tmp;
     if (stat(realPath.c_str(), &tmp)) {
-      TRACE_SIMPGMSPACE("f_open(%s) = INVALID_NAME (FIL %p)", path.c_str(), fil);
-      return FR_INVALID_NAME;
+      TRACE_SIMPGMSPACE("f_open(%s) = error %d (%s) (FIL %p)", path.c_str(), errno, strerror(errno), fil);
+      return (errno == ENOENT) ? FR_NO_FILE : FR_INVALID_NAME;
     }
     fil->obj.objsize = tmp.st_size;
     fil->fptr = 0;
@@ -493,7 +493,7 @@ FRESULT f_unlink (const TCHAR * name)
   std::string path = convertToSimuPath(name);
   if (unlink(path.c_str())) {
     TRACE_SIMPGMSPACE("f_unlink(%s) = error %d (%s)", path.c_str(), errno, strerror(errno));
-    return FR_INVALID_NAME;
+    return (errno == ENOENT) ? FR_NO_FILE : FR_INVALID_NAME;
   }
   else {
     TRACE_SIMPGMSPACE("f_unlink(%s) = OK", path.c_str());
@@ -177,8 +177,13 @@ void lcdRefresh(bool wait)
   }
 
 #if LCD_W == 128
+  uint8_t dirtyPages = lcdGetDirtyPages();
   uint8_t * p = displayBuf;
   for (uint8_t y=0; y < 8; y++, p+=LCD_W) {
+    if (!(dirtyPages & (1 << y))) {
+      continue;
+    }
+
     lcdWriteCommand(0x10); // Column addr 0
     lcdWriteCommand(0xB0 | y); // Page addr y
     lcdWriteCommand(0x04);
@@ -201,19 +206,31 @@ void lcdRefresh(bool wait)
 #else
   // Wait if previous DMA transfer still active
   WAIT_FOR_DMA_END();
+
+  uint8_t dirtyPages = lcdGetDirtyPages();
+  if (!dirtyPages) {
+    return;
+  }
+
+  // one transfer from the first to the last changed page
+  uint8_t first = 0, last = LCD_PAGES - 1;
+  while (!(dirtyPages & (1 << first))) first++;
+  while (!(dirtyPages & (1 << last))) last--;
+
   lcd_busy = true;
 
-  lcdWriteAddress(0, 0);
+  lcdWriteAddress(0, first * 4); // a row address covers 2 lines
 	
   LCD_NCS_LOW();
   LCD_A0_HIGH();
 
   LCD_DMA_Stream->CR &= ~DMA_SxCR_EN; // Disable DMA
   LCD_DMA->HIFCR = LCD_DMA_FLAGS; // Write ones to clear bits
+  LCD_DMA_Stream->M0AR = (uint32_t)(displayBuf + first * (DISPLAY_BUFFER_SIZE / LCD_PAGES));
+  LCD_DMA_Stream->NDTR = (last - first + 1) * (DISPLAY_BUFFER_SIZE / LCD_PAGES);
 
 #if defined(LCD_DUAL_BUFFER)
   // Switch LCD buffer
-  LCD_DMA_Stream->M0AR = (uint32_t)displayBuf;
   displayBuf = (displayBuf == displayBuf1) ? displayBuf2 : displayBuf1;
 #endif
 
@@ -291,6 +308,7 @@ void lcdInit()
 void lcdInitFinish()
 {
   lcdInitFinished = true;
+  lcdInvalidate();
 
   /*
     LCD needs longer time to initialize in low temperatures. The data-sheet
@@ -72,6 +72,9 @@ void stackPaint()
 #if defined(CLI)
   cliStack.paint();
 #endif
+#if !defined(EEPROM) && !defined(SIMU)
+  storageStackPaint();
+#endif
 }
 
 #if defined(STM32) && !defined(SIMU)
@@ -107,7 +110,90 @@ bool isForcePowerOffRequested()
   return false;
 }
 
-uint32_t nextMixerTime[NUM_MODULES];
+#define MIXER_MAX_PERIOD_TICKS         10    // run at least every 20ms
+#define MIXER_MAX_PERIOD_TICKS_USB     5     // every 10ms if USB is active
+#define MIXER_DEADLINE_MARGIN          250   // us, interrupts and OS tick jitter
+
+uint32_t nextMixerTime[NUM_MODULES];         // OS tick when the mixer has to start for the next frame of each module
+uint8_t mixerPeriodTicks[NUM_MODULES];       // 0 if the module doesn't schedule the mixer
+uint16_t mixerDurationEstimate = 2000;       // us, rolling percentile of the last mixer durations
+uint8_t mixerPredictions[NUM_MODULES];      // deadlines predicted since the last one set by the module
+uint32_t mixerRuns;
+uint32_t mixerOutputsRuns[NUM_MODULES];
+MixerSchedulerStats mixerSchedulerStats;
+
+uint16_t mixerDurations[MIXER_DURATION_SAMPLES];
+uint8_t mixerDurationsIndex;
+
+void updateMixerDurationEstimate(uint16_t duration)
+{
+  mixerDurations[mixerDurationsIndex] = duration;
+  mixerDurationsIndex = (mixerDurationsIndex + 1) % MIXER_DURATION_SAMPLES;
+
+  // the 2nd longest of the last 16 durations is roughly the 90th percentile,
+  // it doesn't follow a single spike (SD card access, Lua GC)
+  uint16_t first = 0, second = 0;
+  for (uint8_t i=0; i<MIXER_DURATION_SAMPLES; i++) {
+    uint16_t value = mixerDurations[i];
+    if (value > first) {
+      second = first;
+      first = value;
+    }
+    else if (value > second) {
+      second = value;
+    }
+  }
+  mixerDurationEstimate = second;
+}
+
+// number of OS ticks until the next mixer run, 0 if it is due now
+uint32_t getMixerDelay(uint32_t now, uint32_t lastRunTime)
+{
+#if !defined(SIMU) && defined(STM32)
+  int32_t delay = lastRunTime + (usbStarted() ? MIXER_MAX_PERIOD_TICKS_USB : MIXER_MAX_PERIOD_TICKS) - now;
+#else
+  int32_t delay = lastRunTime + MIXER_MAX_PERIOD_TICKS - now;
+#endif
+  for (uint8_t i=0; i<NUM_MODULES; i++) {
+    if (mixerPeriodTicks[i]) {
+      int32_t moduleDelay = nextMixerTime[i] - now;
+      if (moduleDelay < delay) {
+        delay = moduleDelay;
+      }
+    }
+  }
+  return delay > 0 ? delay : 0;
+}
+
+// no module schedules the mixer anymore
+void resetMixerScheduler()
+{
+  __disable_irq();
+  memclear(nextMixerTime, sizeof(nextMixerTime));
+  memclear(mixerPeriodTicks, sizeof(mixerPeriodTicks));
+  memclear(mixerPredictions, sizeof(mixerPredictions));
+  __enable_irq();
+}
+
+// the next deadlines of the modules served by this run are predicted one tick
+// early, the module interrupt sets the exact one at the beginning of its frame
+void predictNextMixerTimes(uint32_t now)
+{
+  for (uint8_t i=0; i<NUM_MODULES; i++) {
+    __disable_irq();
+    if (mixerPeriodTicks[i] && (int32_t)(nextMixerTime[i] - now) <= 0) {
+      if (++mixerPredictions[i] > 3) {
+        // the module doesn't send frames anymore
+        mixerPeriodTicks[i] = 0;
+      }
+      else {
+        uint32_t next = nextMixerTime[i] + max<uint8_t>(1, mixerPeriodTicks[i] - 1);
+        nextMixerTime[i] = ((int32_t)(next - now) > 0 ? next : now + 1);
+      }
+    }
+    __enable_irq();
+  }
+}
 
 void mixerTask(void * pdata)
 {
@@ -121,45 +207,41 @@ void mixerTask(void * pdata)
       return;
 #endif
 
+    uint32_t delay = getMixerDelay(CoGetOSTime(), lastRunTime);
+
 #if defined(SBUS)
+    // the SBUS frames are delimited by the gaps between them, poll each tick,
+    // also while no frame is received, so that the first ones aren't delayed
     processSbusInput();
+    if (delay > 1) {
+      delay = 1;
+    }
 #endif
 
-    CoTickDelay(1);
+    if (delay > 0) {
+      CoTickDelay(delay);
+      continue;
+    }
 
     if (isForcePowerOffRequested()) {
       pwrOff();
     }
 
     uint32_t now = CoGetOSTime();
-    bool run = false;
-#if !defined(SIMU) && defined(STM32)
-    if ((now - lastRunTime) >= (usbStarted() ? 5 : 10)) {     // run at least every 20ms (every 10ms if USB is active)
-#else
-    if ((now - lastRunTime) >= 10) {     // run at least every 20ms
-#endif
-      run = true;
-    }
-    else if (now == nextMixerTime[0]) {
-      run = true;
-    }
-#if NUM_MODULES >= 2
-    else if (now == nextMixerTime[1]) {
-      run = true;
-    }
-#endif
-    if (!run) {
-      continue;  // go back to sleep
-    }
-
     lastRunTime = now;
+    predictNextMixerTimes(now);
 
     if (!s_pulses_paused) {
       uint16_t t0 = getTmr2MHz();
+      profiler.mixerStart();
 
       DEBUG_TIMER_START(debugTimerMixer);
       CoEnterMutexSection(mixerMutex);
       doMixerCalculations();
+      mixerRuns++;
+      updateMixerDurationEstimate((uint16_t)(getTmr2MHz() - t0) / 2);
+      profiler.outputsReady();
+      PROFILER_STAGE(PROFILER_STAGE_TELEMETRY);
       DEBUG_TIMER_START(debugTimerMixerCalcToUsage);
       DEBUG_TIMER_SAMPLE(debugTimerMixerIterval);
       CoLeaveMutexSection(mixerMutex);
@@ -188,15 +270,29 @@ void mixerTask(void * pdata)
 
       t0 = getTmr2MHz() - t0;
       if (t0 > maxMixerDuration) maxMixerDuration = t0 ;
+      profiler.mixerStop();
     }
   }
 }
 
 void scheduleNextMixerCalculation(uint8_t module, uint16_t period_ms)
 {
-  // Schedule next mixer calculation time,
-  // for now assume mixer calculation takes 2 ms.
-  nextMixerTime[module] = (uint32_t)CoGetOSTime() + period_ms / 2 - 1/*2ms*/;
+  // Schedule the next mixer calculation so that it ends just before the next
+  // frame, whatever the phase of this frame inside the current OS tick
+  uint32_t leadTime = mixerDurationEstimate + MIXER_DEADLINE_MARGIN;
+  uint32_t period = period_ms * 1000;
+  nextMixerTime[module] = (uint32_t)CoGetOSTime() + (period > leadTime ? (period - leadTime) / 2000 : 0);
+  mixerPeriodTicks[module] = period_ms / 2;
+  mixerPredictions[module] = 0;
+
+  // the outputs sent in this frame were already sent in the previous one
+  if (mixerOutputsRuns[module] == mixerRuns) {
+    mixerSchedulerStats.staleFrames++;
+  }
+  mixerOutputsRuns[module] = mixerRuns;
+  mixerSchedulerStats.frames++;
+
+  profiler.outputsUsed();
   DEBUG_TIMER_STOP(debugTimerMixerCalcToUsage);
 }
 
@@ -224,6 +320,8 @@ void menusTask(void * pdata)
   while (pwrCheck() != e_power_off) {
 #endif
     uint32_t start = (uint32_t)CoGetOSTime();
+    ProfilerStamp stamp;
+    profiler.start(stamp);
     DEBUG_TIMER_START(debugTimerPerMain);
 #if defined(COLORLCD) && defined(CLI)
     if (perMainEnabled) {
@@ -233,6 +331,7 @@ void menusTask(void * pdata)
     perMain();
 #endif
     DEBUG_TIMER_STOP(debugTimerPerMain);
+    profiler.addTaskTime(PROFILER_TASK_MENUS, profiler.elapsed(stamp));
     // TODO remove completely massstorage from sky9x firmware
     uint32_t runtime = ((uint32_t)CoGetOSTime() - start);
     // deduct the thread run-time from the wait, if run-time was more than
@@ -278,6 +377,10 @@ void tasksStart()
   audioTaskId = CoCreateTask(audioTask, NULL, 7, &audioStack.stack[AUDIO_STACK_SIZE-1], AUDIO_STACK_SIZE);
 #endif
 
+#if !defined(EEPROM) && !defined(SIMU)
+  storageStart();
+#endif
+
   audioMutex = CoCreateMutex();
   mixerMutex = CoCreateMutex();
 
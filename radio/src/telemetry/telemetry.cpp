@@ -132,12 +132,7 @@ void telemetryWakeup()
 #endif
 
 #if defined(CPUARM)
-  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
-    const TelemetrySensor & sensor = g_model.telemetrySensors[i];
-    if (sensor.type == TELEM_TYPE_CALCULATED) {
-      telemetryItems[i].eval(sensor);
-    }
-  }
+  evalCalculatedSensors();
 #endif
 
 #if defined(VARIO)
@@ -113,6 +113,18 @@ int setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId, ui
 void delTelemetryIndex(uint8_t index);
 int availableTelemetryIndex();
 int lastUsedTelemetryIndex();
+void invalidateTelemetrySensors();
+extern volatile uint32_t telemetrySensorsVersion; // incremented each time the sensors may have changed
+void evalCalculatedSensors();
+
+struct TelemetrySensorsIndexStats {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t stale;
+  uint32_t rebuilds;
+};
+
+extern TelemetrySensorsIndexStats telemetrySensorsIndexStats;
 
 int32_t getTelemetryValue(uint8_t index, uint8_t & prec);
 int32_t convertTelemetryValue(int32_t value, uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec);
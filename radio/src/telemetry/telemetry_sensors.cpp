@@ -23,6 +23,79 @@
 TelemetryItem telemetryItems[MAX_TELEMETRY_SENSORS];
 uint8_t allowNewSensors;
 
+// Open addressing index of the custom sensors, keyed on (id, subId).
+// The instance is not part of the hash because g_model.ignoreSensorIds
+// makes it optional in the match, and the protocol is not part of the
+// match at all: it is only used to choose the defaults of a new sensor.
+// Sensors sharing the same key are chained on consecutive probes, so a
+// lookup walks the chain until it finds an empty slot.
+#define TELEMETRY_SENSORS_INDEX_BITS   6
+#define TELEMETRY_SENSORS_INDEX_SIZE   (1 << TELEMETRY_SENSORS_INDEX_BITS)
+#define TELEMETRY_SENSORS_INDEX_MASK   (TELEMETRY_SENSORS_INDEX_SIZE - 1)
+
+static_assert(TELEMETRY_SENSORS_INDEX_SIZE >= 2 * MAX_TELEMETRY_SENSORS, "Telemetry sensors index too small");
+
+static uint8_t telemetrySensorsIndex[TELEMETRY_SENSORS_INDEX_SIZE]; // sensor index + 1, 0 = empty slot
+static bool telemetrySensorsIndexDirty = true;
+TelemetrySensorsIndexStats telemetrySensorsIndexStats;
+
+static inline uint8_t telemetrySensorsIndexHash(uint16_t id, uint8_t subId)
+{
+  return ((uint32_t)(id ^ (subId << 11)) * 2654435761u) >> (32 - TELEMETRY_SENSORS_INDEX_BITS);
+}
+
+// Deleted sensors are cleared, they have neither a label nor an id. Sensors
+// without a label (e.g. renamed to an empty string) still receive values.
+static inline bool isTelemetrySensorIndexed(const TelemetrySensor & telemetrySensor)
+{
+  return telemetrySensor.type == TELEM_TYPE_CUSTOM && (telemetrySensor.id != 0 || telemetrySensor.isAvailable());
+}
+
+static inline bool isTelemetrySensorMatching(const TelemetrySensor & telemetrySensor, uint16_t id, uint8_t subId, uint8_t instance)
+{
+  return isTelemetrySensorIndexed(telemetrySensor) && telemetrySensor.id == id && telemetrySensor.subId == subId && (telemetrySensor.instance == instance || g_model.ignoreSensorIds);
+}
+
+// Calculated sensors are only evaluated when one of their source items has
+// changed. Items flag themselves in telemetryItemsChanged whenever they are
+// set, cleared or marked old, and the calculated sensors are walked in
+// topological order so that a chain of formulas settles in a single pass.
+static_assert(MAX_TELEMETRY_SENSORS <= 32, "Telemetry sensors don't fit in a 32 bits mask");
+
+#define TELEMETRY_SENSOR_BIT(index)    ((uint32_t)1 << (index))
+
+static uint32_t telemetryItemsChanged;
+static uint32_t calculatedSensorsSources[MAX_TELEMETRY_SENSORS];
+static uint8_t calculatedSensorsOrder[MAX_TELEMETRY_SENSORS];
+static uint8_t calculatedSensorsCount;
+static bool calculatedSensorsDirty = true;
+
+volatile uint32_t telemetrySensorsVersion;
+
+void invalidateTelemetrySensors()
+{
+  telemetrySensorsVersion++;
+  telemetrySensorsIndexDirty = true;
+  calculatedSensorsDirty = true;
+}
+
+static void rebuildTelemetrySensorsIndex()
+{
+  telemetrySensorsIndexDirty = false;
+  memclear(telemetrySensorsIndex, sizeof(telemetrySensorsIndex));
+  for (int index=0; index<MAX_TELEMETRY_SENSORS; index++) {
+    TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
+    if (isTelemetrySensorIndexed(telemetrySensor)) {
+      uint8_t slot = telemetrySensorsIndexHash(telemetrySensor.id, telemetrySensor.subId);
+      while (telemetrySensorsIndex[slot]) {
+        slot = (slot + 1) & TELEMETRY_SENSORS_INDEX_MASK;
+      }
+      telemetrySensorsIndex[slot] = index + 1;
+    }
+  }
+  telemetrySensorsIndexStats.rebuilds++;
+}
+
 bool isFaiForbidden(source_t idx)
 {
   if (idx < MIXSRC_FIRST_TELEM) {
@@ -77,10 +150,19 @@ uint32_t getDistFromEarthAxis(int32_t latitude)
   return 139*(((uint32_t)10000000-((angle2*(uint32_t)123370)/81)+(angle4/25))/12500);
 }
 
+void TelemetryItem::setChanged()
+{
+  if (this >= telemetryItems && this < telemetryItems + MAX_TELEMETRY_SENSORS) {
+    telemetryItemsChanged |= TELEMETRY_SENSOR_BIT(this - telemetryItems);
+  }
+}
+
 void TelemetryItem::setValue(const TelemetrySensor & sensor, int32_t val, uint32_t unit, uint32_t prec)
 {
   int32_t newVal = val;
 
+  setChanged();
+
   if (unit == UNIT_CELLS) {
     uint32_t data = uint32_t(newVal);
     uint8_t cellsCount = (data >> 24);
@@ -265,7 +347,9 @@ void TelemetryItem::per10ms(const TelemetrySensor & sensor)
           return;
         }
         else if (currentItem.isOld()) {
-          lastReceived = TELEMETRY_VALUE_OLD;
+          if (!isOld()) {
+            setOld();
+          }
           return;
         }
         int32_t current = convertTelemetryValue(currentItem.value, currentSensor.unit, currentSensor.prec, UNIT_AMPS, 1);
@@ -274,7 +358,10 @@ void TelemetryItem::per10ms(const TelemetrySensor & sensor)
           currentItem.consumption.prescale -= 3600;
           setValue(sensor, value+1, sensor.unit, sensor.prec);
         }
-        lastReceived = now();
+        if (lastReceived != now()) {
+          lastReceived = now();
+          setChanged();
+        }
       }
       break;
 
@@ -290,7 +377,7 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
       if (sensor.cell.source) {
         TelemetryItem & cellsItem = telemetryItems[sensor.cell.source-1];
         if (cellsItem.isOld()) {
-          lastReceived = TELEMETRY_VALUE_OLD;
+          setOld();
         }
         else {
           unsigned int index = sensor.cell.index;
@@ -339,7 +426,7 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
           return;
         }
         else if (gpsItem.isOld()) {
-          lastReceived = TELEMETRY_VALUE_OLD;
+          setOld();
           return;
         }
         if (sensor.dist.alt) {
@@ -348,7 +435,7 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
             return;
           }
           else if (altItem->isOld()) {
-            lastReceived = TELEMETRY_VALUE_OLD;
+            setOld();
             return;
           }
         }
@@ -403,7 +490,7 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
               return;
             }
             else if (telemetryItem.isOld()) {
-              lastReceived = TELEMETRY_VALUE_OLD;
+              setOld();
               return;
             }
           }
@@ -429,7 +516,7 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
       if (sensor.formula == TELEM_FORMULA_AVERAGE) {
         if (count == 0) {
           if (available)
-            lastReceived = TELEMETRY_VALUE_OLD;
+            setOld();
           return;
         }
         else {
@@ -450,6 +537,107 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
   }
 }
 
+static uint32_t getCalculatedSensorSources(const TelemetrySensor & sensor)
+{
+  uint32_t result = 0;
+  uint8_t sources[4] = { 0, 0, 0, 0 };
+
+  switch (sensor.formula) {
+    case TELEM_FORMULA_CELL:
+      sources[0] = sensor.cell.source;
+      break;
+
+    case TELEM_FORMULA_DIST:
+      sources[0] = sensor.dist.gps;
+      sources[1] = sensor.dist.alt;
+      break;
+
+    case TELEM_FORMULA_ADD:
+    case TELEM_FORMULA_AVERAGE:
+    case TELEM_FORMULA_MIN:
+    case TELEM_FORMULA_MAX:
+    case TELEM_FORMULA_MULTIPLY:
+      for (int i=0; i<4; i++) {
+        sources[i] = abs(sensor.calc.sources[i]);
+      }
+      break;
+
+    default:
+      // consumption and totalize are updated from per10ms() and setValue()
+      break;
+  }
+
+  for (int i=0; i<4; i++) {
+    if (sources[i] && sources[i] <= MAX_TELEMETRY_SENSORS) {
+      result |= TELEMETRY_SENSOR_BIT(sources[i] - 1);
+    }
+  }
+
+  return result;
+}
+
+static void buildCalculatedSensorsGraph()
+{
+  uint32_t pending = 0;
+
+  calculatedSensorsDirty = false;
+  calculatedSensorsCount = 0;
+
+  for (int index=0; index<MAX_TELEMETRY_SENSORS; index++) {
+    const TelemetrySensor & sensor = g_model.telemetrySensors[index];
+    calculatedSensorsSources[index] = (sensor.type == TELEM_TYPE_CALCULATED ? getCalculatedSensorSources(sensor) : 0);
+    if (calculatedSensorsSources[index]) {
+      pending |= TELEMETRY_SENSOR_BIT(index);
+    }
+  }
+
+  // Kahn's algorithm, the lowest index first when several sensors are ready
+  while (pending) {
+    int next = -1;
+    for (int index=0; index<MAX_TELEMETRY_SENSORS; index++) {
+      uint32_t bit = TELEMETRY_SENSOR_BIT(index);
+      if ((pending & bit) && !(calculatedSensorsSources[index] & pending & ~bit)) {
+        next = index;
+        break;
+      }
+    }
+    if (next < 0) {
+      // formulas loop, break the cycle on the lowest index
+      for (next=0; !(pending & TELEMETRY_SENSOR_BIT(next)); next++);
+    }
+    calculatedSensorsOrder[calculatedSensorsCount++] = next;
+    pending &= ~TELEMETRY_SENSOR_BIT(next);
+  }
+}
+
+void evalCalculatedSensors()
+{
+  uint32_t changed;
+
+  if (calculatedSensorsDirty) {
+    buildCalculatedSensorsGraph();
+    changed = (uint32_t)-1;
+  }
+  else {
+    changed = telemetryItemsChanged;
+  }
+
+  telemetryItemsChanged &= ~changed;
+
+  for (int i=0; i<calculatedSensorsCount; i++) {
+    uint8_t index = calculatedSensorsOrder[i];
+    if (calculatedSensorsSources[index] & changed) {
+      telemetryItems[index].eval(g_model.telemetrySensors[index]);
+      uint32_t bit = TELEMETRY_SENSOR_BIT(index);
+      if (telemetryItemsChanged & bit) {
+        // propagate to the formulas using this sensor in the same pass
+        telemetryItemsChanged &= ~bit;
+        changed |= bit;
+      }
+    }
+  }
+}
+
 void delTelemetryIndex(uint8_t index)
 {
   memclear(&g_model.telemetrySensors[index], sizeof(TelemetrySensor));
@@ -483,21 +671,51 @@ int setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId, ui
 {
   bool available = false;
 
-  for (int index=0; index<MAX_TELEMETRY_SENSORS; index++) {
+  if (telemetrySensorsIndexDirty) {
+    rebuildTelemetrySensorsIndex();
+  }
+
+  for (uint8_t slot = telemetrySensorsIndexHash(id, subId); telemetrySensorsIndex[slot]; slot = (slot + 1) & TELEMETRY_SENSORS_INDEX_MASK) {
+    int index = telemetrySensorsIndex[slot] - 1;
     TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
-    if (telemetrySensor.type == TELEM_TYPE_CUSTOM && telemetrySensor.id == id && telemetrySensor.subId == subId && (telemetrySensor.instance == instance || g_model.ignoreSensorIds)) {
+    if (isTelemetrySensorMatching(telemetrySensor, id, subId, instance)) {
       telemetryItems[index].setValue(telemetrySensor, value, unit, prec);
       available = true;
       // we continue search here, because sensors can share the same id and instance
     }
   }
 
-  if (available || !allowNewSensors) {
+  if (available) {
+    telemetrySensorsIndexStats.hits++;
+    return -1;
+  }
+
+  telemetrySensorsIndexStats.misses++;
+
+  // the index may be stale if a sensor has been edited without going through storageDirty(),
+  // a miss is confirmed by a full scan, only frames of sensors not in the model pay for it
+  for (int index=0; index<MAX_TELEMETRY_SENSORS; index++) {
+    TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
+    if (isTelemetrySensorMatching(telemetrySensor, id, subId, instance)) {
+      telemetryItems[index].setValue(telemetrySensor, value, unit, prec);
+      available = true;
+    }
+  }
+
+  if (available) {
+    telemetrySensorsIndexStats.stale++;
+    invalidateTelemetrySensors();
+    return -1;
+  }
+
+  if (!allowNewSensors) {
     return -1;
   }
 
   int index = availableTelemetryIndex();
   if (index >= 0) {
+    // the new sensor is indexed on next lookup, once the caller has set it up
+    invalidateTelemetrySensors();
     switch (protocol) {
 #if defined(TELEMETRY_FRSKY_SPORT)
       case TELEM_PROTO_FRSKY_SPORT:
@@ -93,8 +93,11 @@ class TelemetryItem
     {
       memset(this, 0, sizeof(*this));
       lastReceived = TELEMETRY_VALUE_UNAVAILABLE;
+      setChanged();
     }
 
+    void setChanged();
+
     void eval(const TelemetrySensor & sensor);
     void per10ms(const TelemetrySensor & sensor);
 
@@ -129,6 +132,7 @@ class TelemetryItem
     inline void setOld()
     {
       lastReceived = TELEMETRY_VALUE_OLD;
+      setChanged();
     }
 
     void gpsReceived(); // TODO seems not used
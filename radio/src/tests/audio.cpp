@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <chrono>
+#include <math.h>
+#include <string>
+#include "gtests.h"
+
+#if defined(CPUARM)
+
+// per sample mixing, as done before the block kernels
+static void referenceMixSamples(audio_data_t * result, const int16_t * samples, unsigned int count, unsigned int ratio, unsigned int fade)
+{
+  for (unsigned int i=0; i<count; i++) {
+    for (unsigned int j=0; j<ratio; j++) {
+      *result = limit<int>(AUDIO_DATA_MIN, *result + ((samples[i] >> fade) >> (16-AUDIO_BITS_PER_SAMPLE)), AUDIO_DATA_MAX);
+      result++;
+    }
+  }
+}
+
+static void referenceMixTone(audio_data_t * result, const int16_t * sine, unsigned int count, float & idx, float step, float volume, unsigned int fade)
+{
+  for (unsigned int i=0; i<count; i++) {
+    int16_t sample = sine[int(idx)] * volume;
+    *result = limit<int>(AUDIO_DATA_MIN, *result + ((sample >> fade) >> (16-AUDIO_BITS_PER_SAMPLE)), AUDIO_DATA_MAX);
+    result++;
+    idx += step;
+    if (idx >= 1024)
+      idx -= 1024;
+  }
+}
+
+static void referenceSoftwareVolume(audio_data_t * result, unsigned int count, int volume)
+{
+  for (unsigned int i=0; i<count; i++) {
+    int32_t sample = (int32_t)((uint32_t)result[i] - AUDIO_DATA_SILENCE);
+    result[i] = (int16_t)(((sample * volume) / VOLUME_LEVEL_MAX) + AUDIO_DATA_SILENCE);
+  }
+}
+
+TEST(Audio, mixSamples)
+{
+  int16_t samples[AUDIO_BUFFER_SIZE];
+  audio_data_t expected[AUDIO_BUFFER_SIZE];
+  audio_data_t result[AUDIO_BUFFER_SIZE];
+
+  uint32_t seed = 1;
+  for (int i=0; i<AUDIO_BUFFER_SIZE; i++) {
+    seed = seed * 1103515245 + 12345;
+    samples[i] = seed >> 16;
+  }
+
+  for (unsigned int ratio=1; ratio<=4; ratio*=2) {
+    for (unsigned int fade=0; fade<6; fade++) {
+      for (int i=0; i<AUDIO_BUFFER_SIZE; i++) {
+        // near the limits, so that the saturation is checked as well
+        expected[i] = result[i] = (i & 1) ? AUDIO_DATA_MAX - i : AUDIO_DATA_MIN + i;
+      }
+      referenceMixSamples(expected, samples, AUDIO_BUFFER_SIZE/ratio, ratio, fade);
+      mixSamples(result, samples, AUDIO_BUFFER_SIZE/ratio, ratio, AUDIO_GAIN_UNITY >> fade);
+      EXPECT_EQ(0, memcmp(expected, result, sizeof(result))) << "ratio " << ratio << " fade " << fade;
+    }
+  }
+}
+
+TEST(Audio, mixSpeed)
+{
+  const int count = 20000;
+  static int16_t sine[1024];
+  static int16_t samples[AUDIO_BUFFER_SIZE];
+  static audio_data_t buffer[AUDIO_BUFFER_SIZE];
+
+  for (int i=0; i<1024; i++) {
+    sine[i] = 16000 * sin(2 * M_PI * i / 1024);
+  }
+  for (int i=0; i<AUDIO_BUFFER_SIZE; i++) {
+    samples[i] = sine[(i * 17) & 1023];
+  }
+
+  // a 16kHz file, a tone and the software volume
+  auto start = std::chrono::steady_clock::now();
+  float idx = 0;
+  for (int n=0; n<count; n++) {
+    referenceMixSamples(buffer, samples, AUDIO_BUFFER_SIZE/2, 2, 2);
+    referenceMixTone(buffer, sine, AUDIO_BUFFER_SIZE, idx, 70.4f, 0.25f, 1);
+    referenceSoftwareVolume(buffer, AUDIO_BUFFER_SIZE, 12);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  double before = count * AUDIO_BUFFER_SIZE / elapsed.count() / 1000000;
+
+  start = std::chrono::steady_clock::now();
+  uint32_t phase = 0;
+  for (int n=0; n<count; n++) {
+    mixSamples(buffer, samples, AUDIO_BUFFER_SIZE/2, 2, (AUDIO_GAIN_UNITY >> 2) * 12 / VOLUME_LEVEL_MAX);
+    mixTone(buffer, AUDIO_BUFFER_SIZE, phase, uint32_t(70.4f * 65536), (AUDIO_GAIN_UNITY / 8) * 12 / VOLUME_LEVEL_MAX);
+  }
+  elapsed = std::chrono::steady_clock::now() - start;
+  double after = count * AUDIO_BUFFER_SIZE / elapsed.count() / 1000000;
+
+  printf("mixing: %.2f Msamples/s per sample, %.2f Msamples/s by blocks\n", before, after);
+}
+
+#endif
+
+#if defined(CPUARM) && defined(SDCARD) && defined(SIMU_USE_SDCARD)
+
+static void writeTestWav(const char * path, uint16_t freq, uint16_t codec, int count)
+{
+  uint8_t bytesPerSample = (codec == 1 ? 2 : 1);
+  uint32_t dataSize = count * bytesPerSample;
+  uint8_t header[44];
+  memcpy(header, "RIFF", 4);
+  *(uint32_t *)(header+4) = 36 + dataSize;
+  memcpy(header+8, "WAVEfmt ", 8);
+  *(uint32_t *)(header+16) = 16;
+  *(uint16_t *)(header+20) = codec;
+  *(uint16_t *)(header+22) = 1;
+  *(uint32_t *)(header+24) = freq;
+  *(uint32_t *)(header+28) = freq * bytesPerSample;
+  *(uint16_t *)(header+32) = bytesPerSample;
+  *(uint16_t *)(header+34) = 8 * bytesPerSample;
+  memcpy(header+36, "data", 4);
+  *(uint32_t *)(header+40) = dataSize;
+
+  FIL file;
+  UINT written;
+  ASSERT_EQ(FR_OK, f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE));
+  f_write(&file, header, sizeof(header), &written);
+  for (int i=0; i<count; i++) {
+    // a loud constant sample, so that any gap shows as silence
+    int16_t sample = 8000;
+    uint8_t alaw = 0xAA;
+    f_write(&file, codec == 1 ? (void *)&sample : (void *)&alaw, bytesPerSample, &written);
+  }
+  f_close(&file);
+}
+
+static int playTestBuffers(int consumed, int & total, int & silent, int & partial)
+{
+  for (int i=0; i<200; i++) {
+    audioQueue.wakeup();
+    const AudioBuffer * buffer;
+    for (int n=0; n<consumed && (buffer = audioQueue.buffersFifo.getNextFilledBuffer()); n++) {
+      for (int j=0; j<buffer->size; j++) {
+        if (buffer->data[j] == AUDIO_DATA_SILENCE) silent++;
+      }
+      if (buffer->size < AUDIO_BUFFER_SIZE) partial++;
+      total += buffer->size;
+      audioQueue.buffersFifo.freeNextFilledBuffer();
+    }
+  }
+  return total;
+}
+
+TEST(Audio, stackedPrompts)
+{
+  char sdPath[] = "/tmp/audioXXXXXX";
+  ASSERT_NE((char *)NULL, mkdtemp(sdPath));
+  simuFatfsSetPaths(sdPath, NULL);
+  writeTestWav("/1.wav", 16000, 1, 1000);
+  writeTestWav("/2.wav", 8000, 6, 700);
+  writeTestWav("/3.wav", 32000, 1, 500);
+
+  g_eeGeneral.beepMode = e_mode_all;
+  currentSpeakerVolume = VOLUME_LEVEL_MAX;
+  audioQueue.stopAll();
+  memclear(&audioStats, sizeof(audioStats));
+
+  // the mixer only opens the first file, the next ones are prefetched and follow without any silence
+  audioQueue.playFile("/1.wav");
+  audioQueue.playFile("/2.wav");
+  audioQueue.playFile("/3.wav");
+  int total = 0, silent = 0, partial = 0;
+  playTestBuffers(1, total, silent, partial);
+  EXPECT_EQ(2000+2800+500, total);
+  EXPECT_EQ(0, silent);
+  EXPECT_EQ(1, partial);
+  EXPECT_EQ(2u, audioStats.prefetchHits);
+  EXPECT_EQ(1u, audioStats.syncReads);
+  EXPECT_EQ(0u, audioStats.underruns);
+
+  // a consumer faster than the audio task starves
+  audioQueue.playFile("/1.wav");
+  total = 0;
+  playTestBuffers(AUDIO_BUFFER_COUNT, total, silent, partial);
+  EXPECT_EQ(2000, total);
+  EXPECT_GT(audioStats.underruns, 0u);
+
+  audioQueue.stopAll();
+  simuFatfsSetPaths("", NULL);
+  EXPECT_EQ(0, system((std::string("rm -rf ") + sdPath).c_str()));
+}
+
+#endif
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <chrono>
+#include <vector>
+#include "gtests.h"
+
+#if defined(DISK_CACHE)
+
+// without SD card image, the simu disk fills each sector with its number
+static bool checkSectors(const BYTE * buff, DWORD sector, UINT count)
+{
+  for (UINT i=0; i<count; i++) {
+    if (*(const DWORD *)&buff[i*BLOCK_SIZE] != sector+i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(DiskCache, read)
+{
+  BYTE buff[4*BLOCK_SIZE];
+
+  diskCache.clear();
+  EXPECT_EQ(diskCache.read(0, buff, 100, 2, DISK_CACHE_CLIENT_OTHER, false), RES_OK);
+  EXPECT_TRUE(checkSectors(buff, 100, 2));
+  EXPECT_EQ(diskCache.read(0, buff, 110, 4, DISK_CACHE_CLIENT_OTHER, false), RES_OK);
+  EXPECT_TRUE(checkSectors(buff, 110, 4));
+  EXPECT_EQ(diskCache.getStats().noHits, 1u);
+  EXPECT_EQ(diskCache.getStats().noMisses, 1u);
+
+  // a write invalidates the block
+  EXPECT_EQ(diskCache.write(0, buff, 105, 1), RES_OK);
+  EXPECT_EQ(diskCache.read(0, buff, 100, 2, DISK_CACHE_CLIENT_OTHER, false), RES_OK);
+  EXPECT_EQ(diskCache.getStats().noMisses, 2u);
+}
+
+TEST(DiskCache, leastRecentlyUsed)
+{
+  BYTE buff[BLOCK_SIZE];
+
+  diskCache.clear();
+  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; n++) {
+    diskCache.read(0, buff, n*1000, 1, DISK_CACHE_CLIENT_OTHER, false);
+  }
+  diskCache.read(0, buff, 0, 1, DISK_CACHE_CLIENT_OTHER, false);
+  EXPECT_EQ(diskCache.getStats().noHits, 1u);
+
+  // the block of sector 1000 is now the least recently used one
+  diskCache.read(0, buff, 100000, 1, DISK_CACHE_CLIENT_OTHER, false);
+  diskCache.read(0, buff, 0, 1, DISK_CACHE_CLIENT_OTHER, false);
+  EXPECT_EQ(diskCache.getStats().noHits, 2u);
+  diskCache.read(0, buff, 2000, 1, DISK_CACHE_CLIENT_OTHER, false);
+  EXPECT_EQ(diskCache.getStats().noHits, 3u);
+  diskCache.read(0, buff, 1000, 1, DISK_CACHE_CLIENT_OTHER, false);
+  EXPECT_EQ(diskCache.getStats().noHits, 3u);
+}
+
+TEST(DiskCache, pinnedMetadata)
+{
+  BYTE buff[BLOCK_SIZE];
+
+  diskCache.clear();
+  diskCache.read(0, buff, 50, 1, DISK_CACHE_CLIENT_OTHER, true);
+
+  // many bitmaps loaded later don't evict the FAT sectors
+  for (int n=0; n<4*DISK_CACHE_BLOCKS_NUM; n++) {
+    diskCache.read(0, buff, 10000+n*1000, 1, DISK_CACHE_CLIENT_BITMAPS, false);
+  }
+  diskCache.read(0, buff, 51, 1, DISK_CACHE_CLIENT_OTHER, true);
+  EXPECT_TRUE(checkSectors(buff, 51, 1));
+  EXPECT_EQ(diskCache.getStats().clients[DISK_CACHE_CLIENT_OTHER].noHits, 1u);
+  EXPECT_EQ(diskCache.getStats().clients[DISK_CACHE_CLIENT_BITMAPS].noMisses, 4u*DISK_CACHE_BLOCKS_NUM);
+}
+
+TEST(DiskCache, readAhead)
+{
+  BYTE buff[2*BLOCK_SIZE];
+
+  diskCache.clear();
+  for (int sector=10000; sector<10000+4*DISK_CACHE_BLOCK_SECTORS; sector+=2) {
+    diskCache.read(0, buff, sector, 2, DISK_CACHE_CLIENT_AUDIO, false);
+    EXPECT_TRUE(checkSectors(buff, sector, 2));
+  }
+
+  // the second block reveals the stream, the next ones are read when the previous one is consumed
+  const DiskCacheStats & stats = diskCache.getStats();
+  EXPECT_EQ(stats.clients[DISK_CACHE_CLIENT_AUDIO].noMisses, 2u);
+  EXPECT_EQ(stats.noReadAheads, 3u);
+  EXPECT_EQ(stats.noReadAheadHits, 2u);
+}
+
+struct DiskCacheTraceItem
+{
+  bool write;
+  DWORD sector;
+  UINT count;
+  uint8_t client;
+  bool metadata;
+};
+
+// Audio streaming, bitmaps loading, Lua scripts loading and FAT accesses interleaved
+static void generateDiskCacheTrace(std::vector<DiskCacheTraceItem> & trace)
+{
+  uint32_t seed = 12345;
+  DWORD audioSector = 200000;
+  for (int i=0; i<20000; i++) {
+    seed = seed * 1103515245 + 12345;
+    uint32_t random = seed >> 16;
+    trace.push_back({false, audioSector, 2, DISK_CACHE_CLIENT_AUDIO, false});
+    audioSector += 2;
+    if (i % 16 == 0) {
+      trace.push_back({false, DWORD(100 + random % 64), 1, DISK_CACHE_CLIENT_OTHER, true});
+    }
+    if (i % 64 == 0) {
+      DWORD bitmap = 50000 + (random % 40) * 64;
+      for (int sector=0; sector<64; sector+=8) {
+        trace.push_back({false, bitmap+sector, 8, DISK_CACHE_CLIENT_BITMAPS, false});
+      }
+    }
+    if (i % 500 == 0) {
+      DWORD script = 80000 + (random % 10) * 32;
+      for (int sector=0; sector<32; sector+=4) {
+        trace.push_back({false, script+sector, 4, DISK_CACHE_CLIENT_LUA, false});
+      }
+    }
+  }
+}
+
+// Recorded with DISK_CACHE_TRACE=<file> in the simulator (SIMU_DISKIO), replayed with DISK_CACHE_REPLAY=<file>
+static bool loadDiskCacheTrace(const char * path, std::vector<DiskCacheTraceItem> & trace)
+{
+  FILE * f = fopen(path, "r");
+  if (!f) {
+    return false;
+  }
+  char type;
+  unsigned sector, count, client, metadata;
+  while (fscanf(f, " %c %u %u", &type, &sector, &count) == 3) {
+    if (type == 'R' && fscanf(f, "%u %u", &client, &metadata) == 2) {
+      trace.push_back({false, sector, count, uint8_t(client), metadata != 0});
+    }
+    else if (type == 'W') {
+      trace.push_back({true, sector, count, 0, false});
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+TEST(DiskCache, replay)
+{
+  static BYTE buff[DISK_CACHE_BLOCK_SIZE];
+  std::vector<DiskCacheTraceItem> trace;
+
+  const char * path = getenv("DISK_CACHE_REPLAY");
+  if (!path || !loadDiskCacheTrace(path, trace)) {
+    generateDiskCacheTrace(trace);
+  }
+
+  diskCache.clear();
+  auto start = std::chrono::steady_clock::now();
+  for (auto & item: trace) {
+    if (item.write)
+      diskCache.write(0, buff, item.sector, item.count);
+    else
+      diskCache.read(0, buff, item.sector, item.count, item.client, item.metadata);
+  }
+  auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+  const DiskCacheStats & stats = diskCache.getStats();
+  static const char * const clients[] = { "other", "audio", "lua", "bitmaps" };
+  printf("%d accesses in %dus, %d disk reads (%d read-ahead)\n", (int)trace.size(), (int)duration, stats.noMisses + stats.noReadAheads, stats.noReadAheads);
+  for (int i=0; i<DISK_CACHE_CLIENTS_COUNT; i++) {
+    printf("  %-8s hits %6d misses %6d (%.1f%%)\n", clients[i], stats.clients[i].noHits, stats.clients[i].noMisses, diskCache.getHitRate(i)*0.1f);
+  }
+
+  if (!path) {
+    EXPECT_GT(diskCache.getHitRate(DISK_CACHE_CLIENT_OTHER), 950);
+    EXPECT_GT(diskCache.getHitRate(DISK_CACHE_CLIENT_AUDIO), 990);
+  }
+}
+
+#endif // defined(DISK_CACHE)
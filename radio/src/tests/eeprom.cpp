@@ -18,6 +18,7 @@
  * GNU General Public License for more details.
  */
 
+#include <string>
 #include "gtests.h"
 
 extern const char * eepromFile;
@@ -45,6 +46,49 @@ TEST(Storage, BackupAndRestore)
 }
 #endif
 
+#if !defined(EEPROM) && defined(SIMU_USE_SDCARD)
+TEST(Storage, RecoverTemporaryFile)
+{
+  char sdPath[] = "/tmp/storageXXXXXX";
+  ASSERT_NE((char *)NULL, mkdtemp(sdPath));
+  simuFatfsSetPaths(sdPath, NULL);
+
+  uint8_t data[100];
+  uint8_t buffer[100];
+  FIL file;
+  UINT written;
+  for (int i=0; i<100; i++) data[i] = i;
+
+  // the file is written under a temporary name, then renamed
+  EXPECT_EQ((const char *)NULL, writeFile("/test.bin", data, sizeof(data)));
+  EXPECT_EQ(FR_NO_FILE, f_open(&file, "/test.bin.tmp", FA_OPEN_EXISTING | FA_READ));
+
+  // the power was lost between the removal of the old file and the rename of the new one
+  ASSERT_EQ(FR_OK, f_rename("/test.bin", "/test.bin.tmp"));
+  memclear(buffer, sizeof(buffer));
+  EXPECT_EQ((const char *)NULL, loadFile("/test.bin", buffer, sizeof(buffer)));
+  EXPECT_EQ(0, memcmp(data, buffer, sizeof(data)));
+  EXPECT_EQ(FR_NO_FILE, f_open(&file, "/test.bin.tmp", FA_OPEN_EXISTING | FA_READ));
+
+  // the power was lost while writing the temporary file: the old file is kept, then overwritten by the next write
+  ASSERT_EQ(FR_OK, f_open(&file, "/test.bin.tmp", FA_CREATE_ALWAYS | FA_WRITE));
+  f_write(&file, "OTX", 3, &written);
+  f_close(&file);
+  memclear(buffer, sizeof(buffer));
+  EXPECT_EQ((const char *)NULL, loadFile("/test.bin", buffer, sizeof(buffer)));
+  EXPECT_EQ(0, memcmp(data, buffer, sizeof(data)));
+  data[0] = 0xFF;
+  EXPECT_EQ((const char *)NULL, writeFile("/test.bin", data, sizeof(data)));
+  memclear(buffer, sizeof(buffer));
+  EXPECT_EQ((const char *)NULL, loadFile("/test.bin", buffer, sizeof(buffer)));
+  EXPECT_EQ(0, memcmp(data, buffer, sizeof(data)));
+  EXPECT_EQ(FR_NO_FILE, f_open(&file, "/test.bin.tmp", FA_OPEN_EXISTING | FA_READ));
+
+  simuFatfsSetPaths("", NULL);
+  EXPECT_EQ(0, system((std::string("rm -rf ") + sdPath).c_str()));
+}
+#endif
+
 #if defined(EEPROM_RLC)
 TEST(Eeprom, 100_random_writes)
 {
@@ -170,4 +214,37 @@ TEST(Eeprom, rm)
   }
   EXPECT_EQ(sz, 0);
 }
+
+TEST(Eeprom, differentialWrites)
+{
+  eepromFile = NULL; // in memory
+  uint8_t buf[800];
+  uint8_t buf2[800];
+
+  storageFormat();
+
+  for (int i=0; i<800; i++) buf[i] = (i % 7 == 0) ? 0 : i;
+
+  theFile.writeRlc(5, FILE_TYP_MODEL, buf, sizeof(buf), true);
+  theFile.writeRlc(5, FILE_TYP_MODEL, buf, sizeof(buf), true);
+
+  // the temporary file holds the previous version, only the changed byte is written
+  memclear(&eepromStats, sizeof(eepromStats));
+  buf[400] += 1;
+  theFile.writeRlc(5, FILE_TYP_MODEL, buf, sizeof(buf), true);
+  EXPECT_EQ(eepromStats.files, 1u);
+  EXPECT_LT(eepromStats.bytes, 100u);
+  EXPECT_GT(eepromStats.skippedBytes, 600u);
+
+  theFile.openRlc(5);
+  EXPECT_EQ(theFile.readRlc(buf2, sizeof(buf2)), sizeof(buf));
+  EXPECT_EQ(memcmp(buf, buf2, sizeof(buf)), 0);
+
+  // different data in the temporary blocks is fully written
+  for (int i=0; i<800; i++) buf[i] = (i % 5 == 0) ? 0 : 255 - i;
+  memclear(&eepromStats, sizeof(eepromStats));
+  theFile.writeRlc(6, FILE_TYP_MODEL, buf, sizeof(buf), true);
+  EXPECT_LT(eepromStats.skippedBytes, 50u);
+  EXPECT_GT(eepromStats.bytes, 600u);
+}
 #endif
@@ -553,4 +553,116 @@ TEST(FrSkySPORT, frskyCurrent)
   EXPECT_EQ(telemetryItems[0].valueMax, 505);
 }
 
+TEST(FrSkySPORT, sensorsIndex)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  allowNewSensors = true;
+
+  // two instances of the same sensor
+  EXPECT_EQ(setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID, 0, 1, 100, UNIT_VOLTS, 2), 0);
+  EXPECT_EQ(setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID, 0, 2, 200, UNIT_VOLTS, 2), 1);
+  EXPECT_EQ(telemetryItems[0].value, 100);
+  EXPECT_EQ(telemetryItems[1].value, 200);
+
+  // a copy of the first sensor shares its id and instance
+  g_model.telemetrySensors[2] = g_model.telemetrySensors[0];
+  storageDirty(EE_MODEL);
+  uint32_t hits = telemetrySensorsIndexStats.hits;
+  EXPECT_EQ(setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID, 0, 1, 110, UNIT_VOLTS, 2), -1);
+  EXPECT_EQ(telemetrySensorsIndexStats.hits, hits + 1);
+  EXPECT_EQ(telemetryItems[0].value, 110);
+  EXPECT_EQ(telemetryItems[1].value, 200);
+  EXPECT_EQ(telemetryItems[2].value, 110);
+
+  // the instance is ignored when ignoreSensorIds is set
+  g_model.ignoreSensorIds = 1;
+  EXPECT_EQ(setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID, 0, 3, 120, UNIT_VOLTS, 2), -1);
+  EXPECT_EQ(telemetryItems[0].value, 120);
+  EXPECT_EQ(telemetryItems[1].value, 120);
+  EXPECT_EQ(telemetryItems[2].value, 120);
+  g_model.ignoreSensorIds = 0;
+
+  // a sensor edited without storageDirty() is still found
+  g_model.telemetrySensors[1].id = VFAS_FIRST_ID + 1;
+  uint32_t stale = telemetrySensorsIndexStats.stale;
+  EXPECT_EQ(setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID + 1, 0, 2, 210, UNIT_VOLTS, 2), -1);
+  EXPECT_EQ(telemetrySensorsIndexStats.stale, stale + 1);
+  EXPECT_EQ(telemetryItems[1].value, 210);
+
+  // also while the new sensors are not discovered
+  allowNewSensors = false;
+  EXPECT_EQ(setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID + 1, 0, 2, 212, UNIT_VOLTS, 2), -1);
+  g_model.telemetrySensors[1].id = VFAS_FIRST_ID + 2;
+  stale = telemetrySensorsIndexStats.stale;
+  EXPECT_EQ(setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID + 2, 0, 2, 215, UNIT_VOLTS, 2), -1);
+  EXPECT_EQ(telemetrySensorsIndexStats.stale, stale + 1);
+  EXPECT_EQ(telemetryItems[1].value, 215);
+  g_model.telemetrySensors[1].id = VFAS_FIRST_ID + 1;
+  storageDirty(EE_MODEL);
+  allowNewSensors = true;
+
+  // a sensor without label is indexed as well
+  memclear(g_model.telemetrySensors[1].label, sizeof(g_model.telemetrySensors[1].label));
+  storageDirty(EE_MODEL);
+  EXPECT_EQ(setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID + 1, 0, 2, 220, UNIT_VOLTS, 2), -1);
+  stale = telemetrySensorsIndexStats.stale;
+  uint32_t rebuilds = telemetrySensorsIndexStats.rebuilds;
+  EXPECT_EQ(setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID + 1, 0, 2, 230, UNIT_VOLTS, 2), -1);
+  EXPECT_EQ(telemetrySensorsIndexStats.stale, stale);
+  EXPECT_EQ(telemetrySensorsIndexStats.rebuilds, rebuilds);
+  EXPECT_EQ(telemetryItems[1].value, 230);
+
+  // deleted sensors are not matched anymore
+  delTelemetryIndex(0);
+  delTelemetryIndex(2);
+  EXPECT_EQ(setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID, 0, 1, 130, UNIT_VOLTS, 2), 0);
+}
+
+TEST(FrSkySPORT, calculatedSensorsChain)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  allowNewSensors = true;
+
+  EXPECT_EQ(setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID, 0, 1, 100, UNIT_VOLTS, 2), 0);
+  EXPECT_EQ(setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID, 0, 2, 200, UNIT_VOLTS, 2), 1);
+
+  // sensor 3 is the sum of sensors 4 and 1, sensor 4 the sum of sensors 1 and 2
+  g_model.telemetrySensors[2].type = TELEM_TYPE_CALCULATED;
+  g_model.telemetrySensors[2].formula = TELEM_FORMULA_ADD;
+  g_model.telemetrySensors[2].unit = UNIT_VOLTS;
+  g_model.telemetrySensors[2].prec = 2;
+  g_model.telemetrySensors[2].calc.sources[0] = 4;
+  g_model.telemetrySensors[2].calc.sources[1] = 1;
+  g_model.telemetrySensors[3].type = TELEM_TYPE_CALCULATED;
+  g_model.telemetrySensors[3].formula = TELEM_FORMULA_ADD;
+  g_model.telemetrySensors[3].unit = UNIT_VOLTS;
+  g_model.telemetrySensors[3].prec = 2;
+  g_model.telemetrySensors[3].calc.sources[0] = 1;
+  g_model.telemetrySensors[3].calc.sources[1] = 2;
+  storageDirty(EE_MODEL);
+
+  // the chain settles in a single pass
+  telemetryWakeup();
+  EXPECT_EQ(telemetryItems[3].value, 300);
+  EXPECT_EQ(telemetryItems[2].value, 400);
+
+  // nothing is evaluated again while the sources don't change
+  telemetryItems[2].value = 0;
+  telemetryWakeup();
+  EXPECT_EQ(telemetryItems[2].value, 0);
+
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, VFAS_FIRST_ID, 0, 2, 250, UNIT_VOLTS, 2);
+  telemetryWakeup();
+  EXPECT_EQ(telemetryItems[3].value, 350);
+  EXPECT_EQ(telemetryItems[2].value, 450);
+
+  // a lost source makes the whole chain old
+  telemetryItems[1].setOld();
+  telemetryWakeup();
+  EXPECT_TRUE(telemetryItems[3].isOld());
+  EXPECT_TRUE(telemetryItems[2].isOld());
+}
+
 #endif  //#if defined(TELEMETRY_FRSKY_SPORT)
@@ -61,6 +61,10 @@ inline void MODEL_RESET()
   extern uint8_t s_mixer_first_run_done;
   s_mixer_first_run_done = false;
   lastFlightMode = 255;
+#if defined(CPUARM)
+  invalidateMixerPlan();
+  invalidateCurves();
+#endif
 }
 
 inline void MIXER_RESET()
@@ -77,6 +81,9 @@ inline void MIXER_RESET()
   mixerCurrentFlightMode = lastFlightMode = 0;
   lastAct = 0;
   logicalSwitchesReset();
+#if defined(CPUARM)
+  invalidateMixerPlan();
+#endif
 }
 
 inline void TELEMETRY_RESET()
@@ -92,6 +99,7 @@ inline void TELEMETRY_RESET()
   }
 #endif
   memclear(g_model.telemetrySensors, sizeof(g_model.telemetrySensors));
+  invalidateTelemetrySensors();
 #endif
 }
 
@@ -487,4 +487,26 @@ TEST(Lcd, lcdDrawLine)
   EXPECT_TRUE(checkScreenshot("lcdDrawLine"));
 }
 #endif
+
+#if defined(PCBTARANIS)
+TEST(Lcd, dirtyPages)
+{
+  lcdClear();
+  lcdInvalidate();
+  EXPECT_EQ((1 << LCD_PAGES) - 1, lcdGetDirtyPages());
+
+  // the same screen drawn again doesn't need any transfer
+  lcdClear();
+  EXPECT_EQ(0, lcdGetDirtyPages());
+
+  lcdDrawText(0, 3*FH, "Test");
+  EXPECT_EQ(1 << 3, lcdGetDirtyPages());
+  lcdClear();
+  lcdDrawText(0, 3*FH, "Test");
+  EXPECT_EQ(0, lcdGetDirtyPages());
+
+  lcdDrawSolidVerticalLine(10, 0, LCD_H);
+  EXPECT_EQ((1 << LCD_PAGES) - 1, lcdGetDirtyPages());
+}
+#endif
 #endif
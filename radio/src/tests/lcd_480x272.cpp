@@ -170,5 +170,53 @@ TEST(Lcd_480x272, fonts)
   EXPECT_TRUE(checkScreenshot_480x272("fonts"));
 }
 
+// A settings page: static labels over plain backgrounds, some values, and a text over another one
+static void drawTextHeavyScreen(LcdFlags flags)
+{
+  static const char * const labels[] = { "Model name", "Timer 1", "Timer 2", "Extended limits", "Extended trims", "Display trims", "Trim step", "Throttle reverse" };
+
+  lcd->clear(TEXT_BGCOLOR);
+  lcdDrawSolidFilledRect(0, 0, LCD_W, 45, HEADER_BGCOLOR);
+  lcdDrawText(50, 10, "MODEL SETUP", MENU_TITLE_COLOR|flags);
+  lcdDrawText(LCD_W-10, 20, "12.6V", MENU_TITLE_COLOR|SMLSIZE|RIGHT|flags);
+
+  for (int i=0; i<8; i++) {
+    lcdDrawText(6, 60+i*22, labels[i], TEXT_COLOR|flags);
+    lcdDrawText(200, 60+i*22, i & 1 ? "ON" : "OFF", (i == 3 ? INVERS : 0)|TEXT_COLOR|flags);
+    lcdDrawText(300, 62+i*22, "Fine", TEXT_DISABLE_COLOR|SMLSIZE|flags);
+  }
+
+  lcdDrawText(380, 60, "1:23", DBLSIZE|TEXT_COLOR|flags);
+  lcdDrawText(380, 100, "-45", MIDSIZE|ALARM_COLOR|flags);
+  lcdDrawText(383, 103, "-45", MIDSIZE|CURVE_AXIS_COLOR|flags);
+}
+
+TEST(Lcd_480x272, textCache)
+{
+  static display_t reference[LCD_W*LCD_H];
+
+  loadFontCache();
+  drawTextHeavyScreen(NO_FONTCACHE);
+  memcpy(reference, lcd->getData(), sizeof(reference));
+
+  // the first drawing fills the glyphs atlases and text runs, the second one only blits them
+  clearTextCache();
+  drawTextHeavyScreen(0);
+  EXPECT_EQ(memcmp(reference, lcd->getData(), sizeof(reference)), 0);
+  drawTextHeavyScreen(0);
+  EXPECT_EQ(memcmp(reference, lcd->getData(), sizeof(reference)), 0);
+  EXPECT_GT(textCacheStats.runHits, 20u);
+
+  // once filled, the caches serve all the texts of the screen
+  TextCacheStats stats = textCacheStats;
+  for (int i=0; i<10; i++) {
+    drawTextHeavyScreen(0);
+  }
+  EXPECT_EQ(memcmp(reference, lcd->getData(), sizeof(reference)), 0);
+  EXPECT_EQ(stats.runMisses, textCacheStats.runMisses);
+  EXPECT_EQ(stats.glyphsRendered, textCacheStats.glyphsRendered);
+  EXPECT_GE(textCacheStats.runHits - stats.runHits, 10*20u);
+}
+
 
 #endif
\ No newline at end of file
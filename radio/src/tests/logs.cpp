@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "gtests.h"
+#include "location.h"
+
+#if defined(LOG_BINARY) && defined(TELEMETRY_FRSKY) && defined(SIMU_USE_SDCARD)
+
+extern tmr10ms_t lastLogTime;
+
+static int countColumns(const std::string & line)
+{
+  return std::count(line.begin(), line.end(), ',') + 1;
+}
+
+TEST(Logs, binaryRoundTrip)
+{
+  char sdPath[] = "/tmp/logsXXXXXX";
+  ASSERT_NE((char *)NULL, mkdtemp(sdPath));
+  simuFatfsSetPaths(sdPath, NULL);
+
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  allowNewSensors = true;
+  g_model.header.name[0] = 'L' - 'A' + 1;
+  g_model.customFn[0].swtch = SWSRC_ON;
+  g_model.customFn[0].func = FUNC_LOGS;
+  g_model.customFn[0].all.val = 1;
+  g_model.customFn[0].active = 1;
+
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, 0x0210, 0, 1, 1234, UNIT_VOLTS, 2);
+  for (int i=0; i<30; i++) {
+    if (i == 10) {
+      // a new sensor shows up while the log is open
+      setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, 0x0100, 0, 1, -45, UNIT_METERS, 1);
+    }
+    else if (i == 20) {
+      // and the first one is not logged anymore
+      g_model.telemetrySensors[0].logs = 0;
+    }
+    evalFunctions(g_model.customFn, modelFunctionsContext);
+    lastLogTime = 0;
+    logsWrite();
+  }
+  logsClose();
+
+  std::string command = "cd " + std::string(sdPath) + LOGS_PATH " && " PYTHON_EXECUTABLE " " TESTS_PATH "/../util/logbin2csv.py *" LOGS_EXT " log.csv";
+  ASSERT_EQ(0, system(command.c_str()));
+
+  // each field set has its own CSV header, and each record matches the header before it
+  std::ifstream csv(std::string(sdPath) + LOGS_PATH "/log.csv");
+  std::string line;
+  std::vector<std::string> headers;
+  int columns = 0, records = 0;
+  while (std::getline(csv, line)) {
+    if (line.compare(0, 5, "Time,") == 0 || line.compare(0, 5, "Date,") == 0) {
+      headers.push_back(line);
+      columns = countColumns(line);
+    }
+    else {
+      EXPECT_EQ(columns, countColumns(line)) << line;
+      records++;
+    }
+  }
+  EXPECT_EQ(30, records);
+  ASSERT_EQ(3u, headers.size());
+  EXPECT_NE(std::string::npos, headers[0].find("VFAS(V)"));
+  EXPECT_EQ(std::string::npos, headers[0].find("Alt(m)"));
+  EXPECT_NE(std::string::npos, headers[1].find("Alt(m)"));
+  EXPECT_EQ(std::string::npos, headers[2].find("VFAS(V)"));
+
+  simuFatfsSetPaths("", NULL);
+  EXPECT_EQ(0, system((std::string("rm -rf ") + sdPath).c_str()));
+}
+
+#endif
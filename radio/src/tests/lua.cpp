@@ -19,12 +19,14 @@
  */
 
 #include <math.h>
+#include <chrono>
 #include "gtests.h"
 
 #if defined(LUA)
 
 #define SWAP_DEFINED
 #include "opentx.h"
+#include "bin_allocator.h"
 
 extern const char * zchar2string(const char * zstring, int size);
 #define EXPECT_ZSTREQ(c_string, z_string)   EXPECT_STREQ(c_string, zchar2string(z_string, sizeof(z_string)))
@@ -165,4 +167,219 @@ TEST(Lua, testModelInputs)
 
 }
 
+TEST(Lua, testModelMixes)
+{
+  MODEL_RESET();
+
+  char str[80];
+  sprintf(str, "model.insertMix(0, 0, {name='test1', source=%d, weight=50, offset=25})", MIXSRC_MAX);
+  luaExecStr(str);
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(chans[0], CHANNEL_MAX*3/4);
+
+  // the mixer doesn't use the deleted lines anymore
+  luaExecStr("model.deleteMixes()");
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(chans[0], 0);
+}
+
+TEST(Lua, binAllocator)
+{
+  static BinAllocator<32, 10> bins;
+  void * ptrs[10];
+
+  EXPECT_EQ(0, bins.malloc(33));
+  for (int i=0; i<10; i++) {
+    ptrs[i] = bins.malloc(32);
+    ASSERT_NE((void *)0, ptrs[i]);
+  }
+  EXPECT_EQ(0, bins.malloc(1));
+  EXPECT_EQ(10u, bins.size());
+
+  // only the start of a bin is ours
+  EXPECT_FALSE(bins.is_member((char *)ptrs[3] + 1));
+  EXPECT_FALSE(bins.free((char *)ptrs[3] + 1));
+  int outside;
+  EXPECT_FALSE(bins.free(&outside));
+
+  EXPECT_TRUE(bins.free(ptrs[3]));
+  EXPECT_TRUE(bins.free(ptrs[7]));
+  EXPECT_EQ(8u, bins.size());
+  EXPECT_EQ(10u, bins.peak());
+
+  // freed bins are reused, last freed first
+  EXPECT_EQ(ptrs[7], bins.malloc(10));
+  EXPECT_EQ(ptrs[3], bins.malloc(10));
+  EXPECT_EQ(0, bins.malloc(10));
+
+  for (int i=0; i<10; i++) {
+    EXPECT_TRUE(bins.free(ptrs[i]));
+  }
+  EXPECT_EQ(0u, bins.size());
+  EXPECT_EQ(10u, bins.peak());
+}
+
+static void setTestSensorName(int index, const char * name)
+{
+  char label[TELEM_LABEL_LEN];
+  str2zchar(label, name, TELEM_LABEL_LEN);
+  g_model.telemetrySensors[index].init(label);
+}
+
+static uint16_t findFieldId(const char * name)
+{
+  LuaField field;
+  return luaFindFieldByName(name, field) ? field.id : 0;
+}
+
+TEST(Lua, findFieldByName)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+
+  EXPECT_EQ(MIXSRC_Ail, findFieldId("ail"));
+  EXPECT_EQ(MIXSRC_TX_TIME, findFieldId("clock"));
+  EXPECT_EQ(MIXSRC_CH1, findFieldId("ch1"));
+  EXPECT_EQ(MIXSRC_CH1+9, findFieldId("ch10"));
+  EXPECT_EQ(MIXSRC_CH1+4, findFieldId("ch05"));
+  EXPECT_EQ(MIXSRC_LAST_CH, findFieldId("ch32"));
+  EXPECT_EQ(MIXSRC_FIRST_INPUT, findFieldId("input1"));
+  EXPECT_EQ(MIXSRC_LAST_LOGICAL_SWITCH, findFieldId("ls64"));
+  EXPECT_EQ(MIXSRC_LAST_TRAINER, findFieldId("trn16"));
+  EXPECT_EQ(0, findFieldId("ch"));
+  EXPECT_EQ(0, findFieldId("ch0"));
+  EXPECT_EQ(0, findFieldId("ch33"));
+  EXPECT_EQ(0, findFieldId("ch001"));
+  EXPECT_EQ(0, findFieldId("zzz"));
+
+  LuaField field;
+  EXPECT_TRUE(luaFindFieldByName("gvar3", field, FIND_FIELD_DESC));
+  EXPECT_STREQ("Global variable 3", field.desc);
+
+  setTestSensorName(0, "RSSI");
+  setTestSensorName(3, "VFAS");
+  EXPECT_EQ(MIXSRC_FIRST_TELEM, findFieldId("RSSI"));
+  EXPECT_EQ(MIXSRC_FIRST_TELEM+9, findFieldId("VFAS"));
+  EXPECT_EQ(MIXSRC_FIRST_TELEM+10, findFieldId("VFAS-"));
+  EXPECT_EQ(MIXSRC_FIRST_TELEM+11, findFieldId("VFAS+"));
+  EXPECT_EQ(0, findFieldId("Alt"));
+
+  // the second lookups come from the cache
+  uint32_t hits = luaSensorNamesCacheStats.hits;
+  EXPECT_EQ(MIXSRC_FIRST_TELEM+9, findFieldId("VFAS"));
+  EXPECT_EQ(0, findFieldId("Alt"));
+  EXPECT_EQ(hits+2, luaSensorNamesCacheStats.hits);
+
+  // a new sensor is found as soon as the sensors are invalidated
+  setTestSensorName(1, "Alt");
+  invalidateTelemetrySensors();
+  EXPECT_EQ(MIXSRC_FIRST_TELEM+3, findFieldId("Alt"));
+
+  // a renamed sensor isn't returned from the cache
+  setTestSensorName(3, "Curr");
+  EXPECT_EQ(0, findFieldId("VFAS"));
+  EXPECT_EQ(MIXSRC_FIRST_TELEM+9, findFieldId("Curr"));
+}
+
+TEST(Lua, findFieldByNameSpeed)
+{
+  static const char * const names[] = { "ail", "thr", "ch1", "ch16", "ls12", "gvar1", "RSSI", "VFAS", "S5", "Alt+", "Tmp1", "unknown" };
+
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    char name[8];
+    sprintf(name, "S%d", i);
+    setTestSensorName(i, name);
+  }
+  setTestSensorName(MAX_TELEMETRY_SENSORS-4, "RSSI");
+  setTestSensorName(MAX_TELEMETRY_SENSORS-3, "VFAS");
+  setTestSensorName(MAX_TELEMETRY_SENSORS-2, "Alt");
+  setTestSensorName(MAX_TELEMETRY_SENSORS-1, "Tmp1");
+
+  const int lookups = 1000000;
+  int found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int n=0; n<lookups; n++) {
+    if (findFieldId(names[n % DIM(names)])) found++;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  printf("luaFindFieldByName() %.2f Mlookups/s, sensor names cache %u hits %u misses\n", lookups / elapsed.count() / 1000000, luaSensorNamesCacheStats.hits, luaSensorNamesCacheStats.misses);
+  EXPECT_EQ(lookups - lookups / (int)DIM(names), found);
+
+  start = std::chrono::steady_clock::now();
+  luaExecStr("for i=1,100000 do local v = getValue('VFAS') + getValue('ch1') end");
+  elapsed = std::chrono::steady_clock::now() - start;
+  printf("getValue(name) %.2f Mcalls/s\n", 200000 / elapsed.count() / 1000000);
+}
+
+#if defined(LUA_COMPILER) && defined(SIMU_USE_SDCARD)
+static void writeTestScript(const char * path, const char * content)
+{
+  FIL file;
+  UINT written;
+  ASSERT_EQ(FR_OK, f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE));
+  f_write(&file, content, strlen(content), &written);
+  f_close(&file);
+}
+
+TEST(Lua, bytecodeCache)
+{
+  char sdPath[] = "/tmp/luacacheXXXXXX";
+  ASSERT_NE((char *)NULL, mkdtemp(sdPath));
+  simuFatfsSetPaths(sdPath, NULL);
+  f_mkdir(SCRIPTS_PATH);
+  f_mkdir(SCRIPTS_MIXES_PATH);
+  writeTestScript(SCRIPTS_MIXES_PATH "/a.lua", "return { run=function() return 1 end }");
+  writeTestScript(SCRIPTS_MIXES_PATH "/b.lua", "return { run=function() return 2 end }");
+
+  extern lua_State * lsScripts;
+  luaInit();
+  luaCacheReset();
+  memclear(&luaCacheStats, sizeof(luaCacheStats));
+
+  // first loads compile the sources into the cache
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_MIXES_PATH "/a.lua", "bt"));
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_MIXES_PATH "/b.lua", "bt"));
+  lua_pop(lsScripts, 2);
+  EXPECT_EQ(0u, luaCacheStats.hits);
+  EXPECT_EQ(2u, luaCacheStats.misses);
+  FILINFO info;
+  EXPECT_EQ(FR_OK, f_stat(SCRIPTS_CACHE_INDEX, &info));
+  EXPECT_NE(FR_OK, f_stat(SCRIPTS_MIXES_PATH "/a.luac", &info));
+
+  // next loads, including after a reboot, use the bytecode
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_MIXES_PATH "/a.lua", "bt"));
+  luaCacheReset();
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_MIXES_PATH "/b.lua", "bt"));
+  EXPECT_EQ(2u, luaCacheStats.hits);
+  lua_call(lsScripts, 0, 1);
+  lua_getfield(lsScripts, -1, "run");
+  lua_call(lsScripts, 0, 1);
+  EXPECT_EQ(2, lua_tointeger(lsScripts, -1));
+  lua_pop(lsScripts, 3);
+
+  // an edited source is compiled again
+  writeTestScript(SCRIPTS_MIXES_PATH "/b.lua", "return { run=function() return 33 end }");
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_MIXES_PATH "/b.lua", "bt"));
+  lua_call(lsScripts, 0, 1);
+  lua_getfield(lsScripts, -1, "run");
+  lua_call(lsScripts, 0, 1);
+  EXPECT_EQ(33, lua_tointeger(lsScripts, -1));
+  lua_pop(lsScripts, 2);
+  EXPECT_EQ(3u, luaCacheStats.misses);
+
+  // a broken index is ignored
+  writeTestScript(SCRIPTS_CACHE_INDEX, "garbage");
+  luaCacheReset();
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_MIXES_PATH "/a.lua", "bt"));
+  lua_pop(lsScripts, 1);
+  EXPECT_EQ(4u, luaCacheStats.misses);
+
+  luaCacheReset();
+  simuFatfsSetPaths("", NULL);
+  EXPECT_EQ(0, system((std::string("rm -rf ") + sdPath).c_str()));
+}
+#endif
+
 #endif   // #if defined(LUA)
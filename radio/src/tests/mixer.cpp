@@ -18,6 +18,7 @@
  * GNU General Public License for more details.
  */
 
+#include <chrono>
 #include "gtests.h"
 
 class TrimsTest : public OpenTxTest {};
@@ -407,6 +408,104 @@ TEST(Curves, LinearIntpol)
   EXPECT_EQ(applyCustomCurve(-192, 0), -192);
 }
 
+#if defined(CPUARM)
+int16_t hermite_spline(int16_t x, uint8_t idx);
+
+static void setupTestCurves()
+{
+  struct {
+    uint8_t type;
+    uint8_t count;
+    bool smooth;
+  } curves[] = {
+    { CURVE_TYPE_STANDARD, 5, true },
+    { CURVE_TYPE_STANDARD, 17, false },
+    { CURVE_TYPE_STANDARD, 2, true },
+    { CURVE_TYPE_STANDARD, 7, true },
+    { CURVE_TYPE_CUSTOM, 9, true },
+    { CURVE_TYPE_CUSTOM, 6, false },
+    { CURVE_TYPE_CUSTOM, 17, true },
+    { CURVE_TYPE_CUSTOM, 5, true }, // unordered X points
+  };
+
+  uint32_t seed = 1234;
+  int8_t * points = g_model.points;
+  for (unsigned c=0; c<DIM(curves); c++) {
+    uint8_t count = curves[c].count;
+    g_model.curves[c].type = curves[c].type;
+    g_model.curves[c].points = count - 5;
+    g_model.curves[c].smooth = curves[c].smooth;
+    for (int i=0; i<count; i++) {
+      seed = seed * 1103515245 + 12345;
+      *points++ = (seed >> 16) % 201 - 100;
+    }
+    if (curves[c].type == CURVE_TYPE_CUSTOM) {
+      for (int i=1; i<count-1; i++) {
+        // some points share the same X
+        *points++ = getCurveX(count, i) - (i % 3 == 0 ? 200 / (count-1) : 0);
+      }
+    }
+  }
+  points[-2] = 50;
+  points[-1] = -50;
+  loadCurves();
+}
+
+TEST(Curves, compiled)
+{
+  MODEL_RESET();
+  setupTestCurves();
+
+  for (int c=0; c<8; c++) {
+    CurveInfo & crv = g_model.curves[c];
+    for (int x=-RESX-100; x<=RESX+100; x++) {
+      int expected = crv.smooth ? hermite_spline(x, c) : intpol(x, c);
+      ASSERT_EQ(expected, applyCustomCurve(x, c)) << "curve " << c << " x=" << x;
+    }
+  }
+
+  // an edit is seen without reloading the model
+  EXPECT_EQ(applyCustomCurve(RESX, 0), calc100toRESX(curveAddress(0)[4]));
+  curveAddress(0)[4] = 33;
+  storageDirty(EE_MODEL);
+  EXPECT_EQ(applyCustomCurve(RESX, 0), calc100toRESX(33));
+}
+
+TEST(Curves, compiledSpeed)
+{
+  MODEL_RESET();
+  setupTestCurves();
+
+  const int lookups = 2000000;
+  for (int c=0; c<8; c++) {
+    CurveInfo & crv = g_model.curves[c];
+    int32_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int n=0; n<lookups; n++) {
+      int x = (n * 7) % (2*RESX+1) - RESX;
+      sum += crv.smooth ? hermite_spline(x, c) : intpol(x, c);
+    }
+    std::chrono::duration<double> direct = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (int n=0; n<lookups; n++) {
+      int x = (n * 7) % (2*RESX+1) - RESX;
+      sum -= applyCustomCurve(x, c);
+    }
+    std::chrono::duration<double> compiled = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(0, sum);
+    printf("curve %d (%s %2d pts%s) direct %7.2f compiled %7.2f Mlookups/s\n", c, crv.type == CURVE_TYPE_CUSTOM ? "custom" : "std", crv.points + 5, crv.smooth ? " smooth" : "", lookups / direct.count() / 1000000, lookups / compiled.count() / 1000000);
+  }
+
+  int32_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int n=0; n<lookups; n++) {
+    sum += expo((n * 7) % (2*RESX+1) - RESX, 40);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  printf("expo %7.2f Mlookups/s (%d)\n", lookups / elapsed.count() / 1000000, sum);
+}
+#endif
+
 
 #if !defined(CPUARM)
 TEST(FlightModes, nullFadeOut_posFadeIn)
@@ -547,6 +646,23 @@ TEST_F(MixerTest, InfiniteRecursiveChannels)
   EXPECT_EQ(chans[0], 0);
 }
 
+TEST_F(MixerTest, CascadedUnorderedChannels)
+{
+  g_model.mixData[0].destCh = 0;
+  g_model.mixData[0].srcRaw = MIXSRC_CH3;
+  g_model.mixData[0].weight = 100;
+  g_model.mixData[1].destCh = 1;
+  g_model.mixData[1].srcRaw = MIXSRC_CH1;
+  g_model.mixData[1].weight = 100;
+  g_model.mixData[2].destCh = 2;
+  g_model.mixData[2].srcRaw = MIXSRC_MAX;
+  g_model.mixData[2].weight = 50;
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(chans[0], CHANNEL_MAX/2);
+  EXPECT_EQ(chans[1], CHANNEL_MAX/2);
+  EXPECT_EQ(chans[2], CHANNEL_MAX/2);
+}
+
 TEST_F(MixerTest, BlockingChannel)
 {
   g_model.mixData[0].destCh = 0;
@@ -983,3 +1099,211 @@ TEST(Trainer, UnpluggedTest)
   ppmInput[0] = 1024;
   CHECK_DELAY(0, 5000);
 }
+
+#if defined(CPUARM)
+TEST(Sources, getValue)
+{
+  SYSTEM_RESET();
+  MODEL_RESET();
+  MIXER_RESET();
+  modelDefault(0);
+
+  EXPECT_EQ(getValue(MIXSRC_NONE), 0);
+  EXPECT_EQ(getValue(MIXSRC_MAX), 1024);
+
+  anas[1] = -200;
+  EXPECT_EQ(getValue(MIXSRC_FIRST_INPUT+1), -200);
+
+  calibratedAnalogs[THR_STICK] = 512;
+  EXPECT_EQ(getValue(MIXSRC_Thr), 512);
+
+  ex_chans[2] = 123;
+  EXPECT_EQ(getValue(MIXSRC_CH3), 123);
+
+  ppmInput[0] = 100;
+  g_eeGeneral.trainer.calib[0] = 10;
+  EXPECT_EQ(getValue(MIXSRC_FIRST_TRAINER), 180);
+  g_eeGeneral.trainer.calib[0] = 0;
+  ppmInput[0] = 0;
+
+  timersStates[1].val = 42;
+  EXPECT_EQ(getValue(MIXSRC_TIMER2), 42);
+  timersStates[1].val = 0;
+
+  telemetryItems[1].value = 10;
+  telemetryItems[1].valueMin = 5;
+  telemetryItems[1].valueMax = 20;
+  EXPECT_EQ(getValue(MIXSRC_FIRST_TELEM+3), 10);
+  EXPECT_EQ(getValue(MIXSRC_FIRST_TELEM+4), 5);
+  EXPECT_EQ(getValue(MIXSRC_FIRST_TELEM+5), 20);
+  telemetryItems[1].clear();
+
+  EXPECT_EQ(getValue(MIXSRC_LAST_TELEM+1), 0);
+}
+
+TEST(Sources, getValueSpeed)
+{
+  struct {
+    const char * name;
+    mixsrc_t first;
+    mixsrc_t last;
+  } classes[] = {
+    { "inputs", MIXSRC_FIRST_INPUT, MIXSRC_LAST_INPUT },
+#if defined(LUA_INPUTS)
+    { "lua", MIXSRC_FIRST_LUA, MIXSRC_LAST_LUA },
+#endif
+    { "sticks/pots", MIXSRC_Rud, MIXSRC_LAST_POT },
+    { "max", MIXSRC_MAX, MIXSRC_MAX },
+    { "heli", MIXSRC_CYC1, MIXSRC_CYC3 },
+    { "trims", MIXSRC_FIRST_TRIM, MIXSRC_LAST_TRIM },
+    { "switches", MIXSRC_FIRST_SWITCH, MIXSRC_LAST_SWITCH },
+    { "logical switches", MIXSRC_FIRST_LOGICAL_SWITCH, MIXSRC_LAST_LOGICAL_SWITCH },
+    { "trainer", MIXSRC_FIRST_TRAINER, MIXSRC_LAST_TRAINER },
+    { "channels", MIXSRC_CH1, MIXSRC_LAST_CH },
+    { "gvars", MIXSRC_FIRST_GVAR, MIXSRC_LAST_GVAR },
+    { "tx", MIXSRC_TX_VOLTAGE, MIXSRC_LAST_RESERVE },
+    { "timers", MIXSRC_FIRST_TIMER, MIXSRC_LAST_TIMER },
+    { "telemetry", MIXSRC_FIRST_TELEM, MIXSRC_LAST_TELEM },
+  };
+
+  SYSTEM_RESET();
+  MODEL_RESET();
+  MIXER_RESET();
+  modelDefault(0);
+
+  const int lookups = 200000;
+  for (unsigned c=0; c<DIM(classes); c++) {
+    int32_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int n=0; n<lookups; n++) {
+      sum += getValue(classes[c].first + n % (classes[c].last - classes[c].first + 1));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("getValue() %-16s %8.2f Mlookups/s (%d)\n", classes[c].name, lookups / elapsed.count() / 1000000, sum);
+  }
+}
+
+TEST(Profiler, histogram)
+{
+  ProfilerHistogram histogram;
+  memclear(&histogram, sizeof(histogram));
+  EXPECT_EQ(0u, histogram.getPercentile(50));
+
+  histogram.add(0);
+  histogram.add(1);
+  histogram.add(3);
+  histogram.add(1000);
+  histogram.add(100000000);
+  EXPECT_EQ(1u, histogram.buckets[0]);
+  EXPECT_EQ(1u, histogram.buckets[1]);
+  EXPECT_EQ(1u, histogram.buckets[2]);
+  EXPECT_EQ(1u, histogram.buckets[10]);
+  EXPECT_EQ(1u, histogram.buckets[PROFILER_HISTOGRAM_BUCKETS-1]);
+
+  for (int i=0; i<95; i++) {
+    histogram.add(300);
+  }
+  EXPECT_EQ(100u, histogram.getCount());
+  EXPECT_EQ(512u, histogram.getPercentile(50));
+  EXPECT_EQ(1024u, histogram.getPercentile(99));
+}
+
+TEST(Profiler, mixerStages)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+  profiler.reset();
+
+  for (int i=0; i<10; i++) {
+    profiler.mixerStart();
+    doMixerCalculations();
+    profiler.outputsReady();
+    PROFILER_STAGE(PROFILER_STAGE_TELEMETRY);
+    profiler.mixerStop();
+    profiler.outputsUsed();
+  }
+
+  EXPECT_EQ(10u, profiler.mixerRuns);
+  EXPECT_EQ(10u, profiler.mixerDuration.getCount());
+  EXPECT_EQ(10u, profiler.mixerToPulses.getCount());
+  EXPECT_EQ(0u, profiler.stageTime[PROFILER_STAGE_NONE]);
+  uint64_t stages = 0;
+  for (int i=0; i<PROFILER_STAGES_COUNT; i++) {
+    stages += profiler.stageTime[i];
+  }
+  // each stage is rounded down to the us
+  EXPECT_LE(stages, profiler.taskTime[PROFILER_TASK_MIXER]);
+  EXPECT_GE(stages + 10*PROFILER_STAGES_COUNT, profiler.taskTime[PROFILER_TASK_MIXER]);
+
+  // evalFlightModeMixes() outside of the mixer task doesn't change the stages
+  uint64_t mixes = profiler.stageTime[PROFILER_STAGE_MIXES];
+  evalFlightModeMixes(e_perout_mode_noinput, 0);
+  EXPECT_EQ(mixes, profiler.stageTime[PROFILER_STAGE_MIXES]);
+}
+
+TEST(MixerScheduler, durationEstimate)
+{
+  for (int i=0; i<MIXER_DURATION_SAMPLES; i++) {
+    updateMixerDurationEstimate(500 + i);
+  }
+  EXPECT_EQ(500 + MIXER_DURATION_SAMPLES - 2, mixerDurationEstimate);
+
+  // a single spike is ignored
+  updateMixerDurationEstimate(5000);
+  EXPECT_EQ(500 + MIXER_DURATION_SAMPLES - 1, mixerDurationEstimate);
+  updateMixerDurationEstimate(4000);
+  EXPECT_EQ(4000, mixerDurationEstimate);
+}
+
+TEST(MixerScheduler, deadlines)
+{
+  uint32_t now = 0xFFFFFFF0; // OS ticks wrap around
+
+  resetMixerScheduler();
+  EXPECT_EQ(10u, getMixerDelay(now, now));
+  EXPECT_EQ(0u, getMixerDelay(now, now-10));
+
+  // PXX (9ms) on the internal module, PPM (22ms) on the external one
+  nextMixerTime[0] = now + 4;
+  mixerPeriodTicks[0] = 4;
+  nextMixerTime[1] = now + 7;
+  mixerPeriodTicks[1] = 11;
+  EXPECT_EQ(4u, getMixerDelay(now, now));
+
+  now += 4;
+  EXPECT_EQ(0u, getMixerDelay(now, now-4));
+  predictNextMixerTimes(now);
+  // predicted one tick early
+  EXPECT_EQ(now + 3, nextMixerTime[0]);
+  EXPECT_EQ(now + 3, nextMixerTime[1]);
+  EXPECT_EQ(3u, getMixerDelay(now, now));
+
+  now += 3;
+  predictNextMixerTimes(now);
+  EXPECT_EQ(now + 3, nextMixerTime[0]);
+  EXPECT_EQ(now + 10, nextMixerTime[1]);
+
+  // a module which doesn't send frames anymore is dropped
+  for (int i=0; i<3; i++) {
+    now = nextMixerTime[0];
+    predictNextMixerTimes(now);
+  }
+  EXPECT_EQ(0, mixerPeriodTicks[0]);
+  resetMixerScheduler();
+}
+
+TEST(MixerScheduler, staleFrames)
+{
+  extern uint32_t mixerRuns;
+  resetMixerScheduler();
+  memclear(&mixerSchedulerStats, sizeof(mixerSchedulerStats));
+  mixerRuns++;
+  scheduleNextMixerCalculation(0, 9);
+  scheduleNextMixerCalculation(0, 9);
+  mixerRuns++;
+  scheduleNextMixerCalculation(0, 9);
+  EXPECT_EQ(3u, mixerSchedulerStats.frames);
+  EXPECT_EQ(1u, mixerSchedulerStats.staleFrames);
+  resetMixerScheduler();
+}
+#endif
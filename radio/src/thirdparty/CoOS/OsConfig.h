@@ -60,7 +60,7 @@ Defines the lowest priority that be assigned.
 /*!< 
 Max number of tasks that can be running.		     
 */			
-#define CFG_MAX_USER_TASKS      (5)
+#define CFG_MAX_USER_TASKS      (6)   // mixer, menus, audio, CLI, storage (SD card radios), bluetooth (sky9x)
 
 /*!< 
 Idle task stack size(word).		                         
@@ -0,0 +1,143 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# This program converts binary SD logs (firmware built with LOG_BINARY=YES)
+# to the CSV layout written by the standard firmware.
+
+from __future__ import division, print_function
+
+import argparse
+import os
+import struct
+import sys
+
+LOG_MAGIC = b'OTXL'
+LOG_BINARY_VERSION = 1
+LOG_RECORD_TAG = 0x01
+
+LOG_FIELD_END = 0
+LOG_FIELD_DATE = 1
+LOG_FIELD_TIME = 2
+LOG_FIELD_VALUE = 3
+LOG_FIELD_GPS = 4
+LOG_FIELD_DATETIME = 5
+LOG_FIELD_ANALOG = 6
+LOG_FIELD_SWITCH = 7
+LOG_FIELD_LOGICAL_SWITCHES = 8
+
+FIELD_FORMATS = {
+    LOG_FIELD_DATE: '<HBBBBBB',
+    LOG_FIELD_TIME: '<I',
+    LOG_FIELD_VALUE: '<i',
+    LOG_FIELD_GPS: '<ii',
+    LOG_FIELD_DATETIME: '<HBBBBBB',
+    LOG_FIELD_ANALOG: '<h',
+    LOG_FIELD_SWITCH: '<b',
+    LOG_FIELD_LOGICAL_SWITCHES: '<II',
+}
+
+
+def formatDecimal(value, prec, width):
+    # same output as the firmware: sign, then integer part and decimals of the absolute value
+    sign = '-' if value < 0 else ''
+    divisor = 10 ** prec
+    return '%s%d.%0*d' % (sign, abs(value) // divisor, width, abs(value) % divisor)
+
+
+def formatField(fieldType, prec, values):
+    if fieldType == LOG_FIELD_DATE:
+        year, month, day, hour, minute, sec, ms100 = values
+        return '%4d-%02d-%02d,%02d:%02d:%02d.%02d0' % (year, month, day, hour, minute, sec, ms100)
+    elif fieldType == LOG_FIELD_DATETIME:
+        year, month, day, hour, minute, sec, _ = values
+        return '%4d-%02d-%02d %02d:%02d:%02d' % (year, month, day, hour, minute, sec)
+    elif fieldType == LOG_FIELD_GPS:
+        latitude, longitude = values
+        if latitude and longitude:
+            return '%s %s' % (formatDecimal(latitude, 6, 6), formatDecimal(longitude, 6, 6))
+        return ''
+    elif fieldType == LOG_FIELD_LOGICAL_SWITCHES:
+        return '0x%08X%08X' % values
+    elif fieldType == LOG_FIELD_VALUE and prec > 0:
+        return formatDecimal(values[0], prec, prec)
+    else:
+        return '%d' % values[0]
+
+
+class LogConverter(object):
+    def __init__(self, data, output):
+        self.data = data
+        self.output = output
+        self.offset = 0
+        self.fields = None
+        self.recordSize = 0
+        self.header = None
+
+    def readHeader(self):
+        if self.data[self.offset:self.offset + 4] != LOG_MAGIC:
+            raise ValueError('Bad header at offset %d' % self.offset)
+        version = ord(self.data[self.offset + 4:self.offset + 5])
+        if version != LOG_BINARY_VERSION:
+            raise ValueError('Unsupported log version %d' % version)
+        self.offset += 5
+        self.fields = []
+        self.recordSize = 0
+        while True:
+            fieldType = ord(self.data[self.offset:self.offset + 1])
+            self.offset += 1
+            if fieldType == LOG_FIELD_END:
+                break
+            prec = ord(self.data[self.offset:self.offset + 1])
+            self.offset += 1
+            fieldFormat = FIELD_FORMATS[fieldType]
+            self.fields.append((fieldType, prec, fieldFormat, self.recordSize))
+            self.recordSize += struct.calcsize(fieldFormat)
+        end = self.data.index(b'\n', self.offset) + 1
+        header = self.data[self.offset:end]
+        self.offset = end
+        # a header identical to the previous one is not repeated in the CSV
+        if header != self.header:
+            self.output.write(header.decode('utf-8', 'replace'))
+            self.header = header
+
+    def readRecord(self):
+        record = self.data[self.offset + 1:self.offset + 1 + self.recordSize]
+        if len(record) < self.recordSize:
+            # log truncated while writing
+            self.offset = len(self.data)
+            return
+        self.offset += 1 + self.recordSize
+        columns = [formatField(fieldType, prec, struct.unpack_from(fieldFormat, record, offset)) for fieldType, prec, fieldFormat, offset in self.fields]
+        self.output.write(','.join(columns) + '\n')
+
+    def convert(self):
+        while self.offset < len(self.data):
+            tag = self.data[self.offset:self.offset + 1]
+            if tag == LOG_MAGIC[0:1]:
+                self.readHeader()
+            elif ord(tag) == LOG_RECORD_TAG and self.fields is not None:
+                self.readRecord()
+            else:
+                raise ValueError('Bad record at offset %d' % self.offset)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert binary SD logs to CSV')
+    parser.add_argument('input', help='binary log file (.blg)')
+    parser.add_argument('output', nargs='?', help='CSV file (default: input with .csv extension)')
+    args = parser.parse_args()
+
+    output = args.output or os.path.splitext(args.input)[0] + '.csv'
+    with open(args.input, 'rb') as f:
+        data = f.read()
+    with open(output, 'w') as f:
+        try:
+            LogConverter(data, f).convert()
+        except ValueError as e:
+            print('%s: %s' % (args.input, e), file=sys.stderr)
+            return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
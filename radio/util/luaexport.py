@@ -42,6 +42,11 @@ def LEXP(name, description):
 
 def LEXP_MULTIPLE(nameFormat, descriptionFormat, valuesCount):
     # print "LEXP_MULTIPLE %s, %s, %s" % (nameFormat, descriptionFormat, valuesCount)
+    global error
+    if nameFormat[-1:].isdigit():
+        # the firmware looks up these names by the part before the trailing digits
+        print("ERROR: Name %s ends with a digit for constant %s" % (nameFormat, CONSTANT_VALUE))
+        error = True
     for v in range(valuesCount):
         name = nameFormat + str(v)
         # print name
@@ -137,8 +142,10 @@ with open(outputFile, "w") as out:
 
     out.write("""
     // The list of Lua fields that have a range of values
+    // this aray is alphabetically sorted by the second field (name)
     const LuaMultipleField luaMultipleFields[] = {
     """)
+    exports_multiple.sort(key=lambda x: x[1])  # sort by name
     data = ["    {%s, \"%s\", \"%s\", %d}" % export for export in exports_multiple]
     out.write(",\n".join(data))
     out.write("\n};\n\n")
@@ -140,9 +140,9 @@ if [[ " X7 ALL " =~ " ${FLAVOR} " ]] ; then
 fi
 
 if [[ " XLITE ALL " =~ " ${FLAVOR} " ]] ; then
-  # OpenTX on X-Lite
+  # OpenTX on X-Lite with binary SD logs
   rm -rf *
-  cmake ${COMMON_OPTIONS} -DPCB=XLITE -DHELI=YES -DGVARS=YES ${SRCDIR}
+  cmake ${COMMON_OPTIONS} -DPCB=XLITE -DHELI=YES -DGVARS=YES -DLOG_BINARY=YES ${SRCDIR}
   make -j${CORES} ${FIRMARE_TARGET}
   make -j${CORES} libsimulator
   make -j${CORES} gtests ; ./gtests ${TEST_OPTIONS}